@@ -0,0 +1,405 @@
+/**
+ * @file ColorImage.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for ColorImage class and its filters
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "ColorImage.h"
+#include "MatrixProfiler.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * MATRIX_DIMENSION_ERROR_MSG message for MatrixException in case of invalid
+ * dimensions (or amount of channels)
+ */
+#define MATRIX_DIMENSION_ERROR_MSG "Invalid matrix dimensions.\n"
+
+/**
+ * INDEX_RANGE_ERROR_MSG message for MatrixException in case of accessing
+ * out of image range
+ */
+#define INDEX_RANGE_ERROR_MSG "Index out of range.\n"
+
+/**
+ * ALLOC_FAIL_MSG message for MatrixException in case of a allocation failure
+ */
+#define ALLOC_FAIL_MSG "Allocation failed.\n"
+
+/**
+ * MAX_COLOR maximum color value
+ */
+#define MAX_COLOR 256
+
+/**
+ * MIN_COLOR minimum color value
+ */
+#define MIN_COLOR 0
+
+/**
+ * KERNEL_SIZE amount of cells in a 3x3 convolution kernel
+ */
+#define KERNEL_SIZE 9
+
+/**
+ * CELL_BLOCK cells of a row processed together by the filters' inner loops
+ * (two 4 float or one 8 float vector)
+ */
+#define CELL_BLOCK 8
+
+/**
+ * convolution kernels of the filters, same values as the matrices of
+ * Filters.cc
+ */
+static const float blur_kernel[KERNEL_SIZE] = {0.0625f, 0.125f, 0.0625f,
+                                               0.125f, 0.25f, 0.125f,
+                                               0.0625f, 0.125f, 0.0625f};
+static const float sobel_x_kernel[KERNEL_SIZE] = {0.125f, 0, -0.125f,
+                                                  0.25f, 0, -0.25f,
+                                                  0.125f, 0, -0.125f};
+static const float sobel_y_kernel[KERNEL_SIZE] = {0.125f, 0.25f, 0.125f,
+                                                  0, 0, 0,
+                                                  -0.125f, -0.25f, -0.125f};
+
+/**
+ * defined in Filters.cc
+ * @param levels number of levels wanted in the division of the colors
+ * @param colors_in_level number of colors in each level
+ * @return returns new allocated array with the averages
+ */
+int *GetAverages(int levels, int colors_in_level) noexcept;
+
+/**
+ * @param channels amount of channels
+ * @return channels, if between 1 and COLOR_MAX_CHANNELS
+ */
+static size_t CheckedChannels(size_t channels){
+  if(channels == 0 || channels > COLOR_MAX_CHANNELS){
+    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+  }
+  return channels;
+}
+
+/**
+ * @param cols amount of columns
+ * @param channels amount of channels
+ * @return cols * channels, if it doesn't overflow
+ */
+static size_t CheckedWidth(size_t cols, size_t channels){
+  if(cols > SIZE_MAX / channels){
+    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+  }
+  return cols * channels;
+}
+
+/**
+ * constructor for an all-zeros image
+ * @param rows number of rows (pixels)
+ * @param cols number of columns (pixels)
+ * @param channels channels per pixel, 1 to COLOR_MAX_CHANNELS
+ * @param layout order of the cells (INTERLEAVED by default)
+ */
+ColorImage::ColorImage(size_t rows, size_t cols, size_t channels,
+                       ChannelLayout layout)
+    : _rows(rows), _cols(cols), _channels(CheckedChannels(channels)),
+      _layout(layout),
+      _data(layout == INTERLEAVED ? rows : CheckedWidth(rows, channels),
+            layout == INTERLEAVED ? CheckedWidth(cols, channels) : cols) {}
+
+/**
+ * constructor merging one matrix per channel into an image
+ * @param channels matrices of the same size, 1 to COLOR_MAX_CHANNELS
+ * @param layout order of the cells (INTERLEAVED by default)
+ */
+ColorImage::ColorImage(const std::vector<Matrix>& channels,
+                       ChannelLayout layout)
+    : ColorImage(channels.empty() ? 0 : channels[0].GetRows(),
+                 channels.empty() ? 0 : channels[0].GetCols(),
+                 channels.size(), layout) {
+  for(const Matrix &channel : channels){
+    if(channel.GetRows() != _rows || channel.GetCols() != _cols){
+      throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+    }
+  }
+  float *dst = _data.GetMatrix();
+  ParallelRows(_rows, _cols * _channels, [&](size_t first, size_t last){
+    for(size_t c = 0; c < _channels; ++c){
+      const float *src = channels[c].GetMatrix();
+      for(size_t i = first; i < last; ++i){
+        for(size_t j = 0; j < _cols; ++j){
+          dst[GetOffset(i, j, c)] = src[i * _cols + j];
+        }
+      }
+    }
+  });
+}
+
+/**
+ * copies one channel out of the image
+ * @param channel channel to copy
+ * @return rows x cols matrix of the channel
+ */
+Matrix ColorImage::GetChannel(size_t channel) const{
+  if(channel >= _channels){
+    throw MatrixException(INDEX_RANGE_ERROR_MSG);
+  }
+  Matrix result(_rows, _cols);
+  const float *src = _data.GetMatrix();
+  float *dst = result.GetMatrix();
+  ParallelRows(_rows, _cols, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      for(size_t j = 0; j < _cols; ++j){
+        dst[i * _cols + j] = src[GetOffset(i, j, channel)];
+      }
+    }
+  });
+  return result;
+}
+
+/**
+ * @param layout wanted layout
+ * @return copy of the image in the given layout
+ */
+ColorImage ColorImage::ToLayout(ChannelLayout layout) const{
+  if(layout == _layout){
+    return *this;
+  }
+  ColorImage result(_rows, _cols, _channels, layout);
+  const float *src = _data.GetMatrix();
+  float *dst = result._data.GetMatrix();
+  ParallelRows(_rows, _cols * _channels, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      for(size_t j = 0; j < _cols; ++j){
+        for(size_t c = 0; c < _channels; ++c){
+          dst[result.GetOffset(i, j, c)] = src[GetOffset(i, j, c)];
+        }
+      }
+    }
+  });
+  return result;
+}
+
+/**
+ * access to a cell by pixel and channel
+ * @param row pixel's row
+ * @param col pixel's column
+ * @param channel channel of the pixel
+ * @return reference to the cell
+ */
+float& ColorImage::operator()(size_t row, size_t col, size_t channel){
+  if(row >= _rows || col >= _cols || channel >= _channels){
+    throw MatrixException(INDEX_RANGE_ERROR_MSG);
+  }
+  return _data.GetMatrix()[GetOffset(row, col, channel)];
+}
+
+/**
+ * access to a cell by pixel and channel
+ * @param row pixel's row
+ * @param col pixel's column
+ * @param channel channel of the pixel
+ * @return the cell's value
+ */
+float ColorImage::operator()(size_t row, size_t col, size_t channel) const{
+  if(row >= _rows || col >= _cols || channel >= _channels){
+    throw MatrixException(INDEX_RANGE_ERROR_MSG);
+  }
+  return _data.GetMatrix()[GetOffset(row, col, channel)];
+}
+
+/**
+ * adds one kernel row to a row of sums: sums[x] += weights[0] * src[x - step]
+ * + weights[1] * src[x] + weights[2] * src[x + step], leaving out the terms
+ * outside the row. the additions are in the order of CellConvolution, so the
+ * sums are the same; every x is independent, so the loops vectorize over
+ * the pixels and channels of the row
+ * @param sums row of sums
+ * @param src source row
+ * @param width cells in a row
+ * @param step distance between horizontally adjacent pixels of a channel
+ * @param weights 3 weights of the kernel row
+ */
+static void AddKernelRow(float* sums, const float* src, size_t width,
+                         size_t step, const float* weights) noexcept{
+  float left = weights[0];
+  float center = weights[1];
+  float right = weights[2];
+  if(width <= step){
+    //a single pixel in the row
+    for(size_t x = 0; x < width; ++x){
+      sums[x] = sums[x] + center * src[x];
+    }
+    return;
+  }
+  for(size_t x = 0; x < step; ++x){
+    sums[x] = (sums[x] + center * src[x]) + right * src[x + step];
+  }
+  size_t x = step;
+  //fixed size blocks, all loads before the stores and unrolled, so the
+  //compiler vectorizes them even where it doesn't vectorize loops of unknown
+  //length (gcc -O2). 8 = CELL_BLOCK
+  for(; x + CELL_BLOCK <= width - step; x += CELL_BLOCK){
+    float *block = sums + x;
+    const float *left_cells = src + x - step;
+    const float *center_cells = src + x;
+    const float *right_cells = src + x + step;
+    float result[CELL_BLOCK];
+#pragma GCC unroll 8
+    for(size_t k = 0; k < CELL_BLOCK; ++k){
+      result[k] = ((block[k] + left * left_cells[k]) +
+                   center * center_cells[k]) + right * right_cells[k];
+    }
+#pragma GCC unroll 8
+    for(size_t k = 0; k < CELL_BLOCK; ++k){
+      block[k] = result[k];
+    }
+  }
+  for(; x < width - step; ++x){
+    sums[x] = ((sums[x] + left * src[x - step]) + center * src[x]) +
+              right * src[x + step];
+  }
+  for(size_t x = width - step; x < width; ++x){
+    sums[x] = (sums[x] + left * src[x - step]) + center * src[x];
+  }
+}
+
+/**
+ * 3x3 convolution of one row of a plane, zero outside the plane, not
+ * rounded
+ * @param sums output row
+ * @param plane source plane
+ * @param rows rows of the plane
+ * @param width cells in a row
+ * @param step distance between horizontally adjacent pixels of a channel
+ * @param row row to convolve
+ * @param kernel 3x3 kernel
+ */
+static void ConvolveRow(float* sums, const float* plane, size_t rows,
+                        size_t width, size_t step, size_t row,
+                        const float* kernel) noexcept{
+  std::fill(sums, sums + width, 0.0f);
+  for(size_t i = 0; i < 3; ++i){
+    if(row + i < 1 || row + i - 1 >= rows){
+      continue;
+    }
+    AddKernelRow(sums, plane + (row + i - 1) * width, width, step,
+                 kernel + 3 * i);
+  }
+}
+
+/**
+ * runs func(src plane, dst plane, plane rows, width, step, row) for every
+ * row of every plane of image, rows in parallel. an interleaved image is one
+ * plane whose adjacent pixels are channels cells apart, a planar image is
+ * a plane per channel
+ * @param image source image
+ * @param result destination image (same size and layout)
+ * @param func called for every row
+ */
+template<typename Func>
+static void ForEachPlaneRow(const ColorImage& image, ColorImage& result,
+                            Func func){
+  bool planar = image.GetLayout() == PLANAR;
+  size_t rows = image.GetRows();
+  size_t planes = planar ? image.GetChannels() : 1;
+  size_t width = planar ? image.GetCols() :
+                 image.GetCols() * image.GetChannels();
+  size_t step = planar ? 1 : image.GetChannels();
+  const float *src = image.GetData();
+  float *dst = result.GetData();
+  ParallelRows(planes * rows, width, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      size_t plane_offset = (i / rows) * rows * width;
+      func(src + plane_offset, dst + plane_offset, rows, width, step,
+           i % rows);
+    }
+  });
+}
+
+/**
+ * quantization filter on every channel of an image
+ * @param image image colors by numeric values
+ * @param levels number of levels we want to divide the colors by
+ * @return new image (same layout) which is the result of the process
+ */
+ColorImage Quantization(const ColorImage& image, int levels){
+  size_t width = image.GetCols() * image.GetChannels();
+  MATRIX_PROFILE_SCOPE(PROFILE_QUANTIZATION,
+                       2 * image.GetRows() * width * sizeof(float));
+  int colors_in_level = MAX_COLOR / levels;
+  ColorImage result(image.GetRows(), image.GetCols(), image.GetChannels(),
+                    image.GetLayout());
+  int *avg_array = GetAverages(levels, colors_in_level);
+  if(avg_array == nullptr){
+    throw MatrixException(ALLOC_FAIL_MSG);
+  }
+  //the cells of both layouts are rows x width in memory
+  const float *src = image.GetData();
+  float *dst = result.GetData();
+  ParallelRows(image.GetRows(), width, [&](size_t first, size_t last){
+    for(size_t i = first * width; i < last * width; ++i){
+      int avg_index = std::min((int)std::floor(src[i] /
+                               (float)colors_in_level), levels - 1);
+      dst[i] = (float)avg_array[avg_index];
+    }
+  });
+  delete[] avg_array;
+  return result;
+}
+
+/**
+ * Blur filter on every channel of an image in one pass
+ * @param image image colors by numeric values
+ * @return new image (same layout) which is the result of the process
+ */
+ColorImage Blur(const ColorImage& image){
+  MATRIX_PROFILE_SCOPE(PROFILE_BLUR, 2 * image.GetRows() * image.GetCols() *
+                       image.GetChannels() * sizeof(float));
+  ColorImage blurred(image.GetRows(), image.GetCols(), image.GetChannels(),
+                     image.GetLayout());
+  ForEachPlaneRow(image, blurred, [](const float* src, float* dst,
+      size_t rows, size_t width, size_t step, size_t row){
+    float *sums = dst + row * width;
+    ConvolveRow(sums, src, rows, width, step, row, blur_kernel);
+    for(size_t x = 0; x < width; ++x){
+      sums[x] = std::rintf(sums[x]);
+    }
+  });
+  return blurred;
+}
+
+/**
+ * Sobel filter on every channel of an image in one pass
+ * @param image image colors by numeric values
+ * @return new image (same layout) which is the result of the process
+ */
+ColorImage Sobel(const ColorImage& image){
+  MATRIX_PROFILE_SCOPE(PROFILE_SOBEL, 2 * image.GetRows() * image.GetCols() *
+                       image.GetChannels() * sizeof(float));
+  ColorImage result(image.GetRows(), image.GetCols(), image.GetChannels(),
+                    image.GetLayout());
+  //y sums, allocated here since the workers of ParallelRows must not throw;
+  //the cell of a y sum is the cell of its x sum in result
+  ColorImage y_sums(image.GetRows(), image.GetCols(), image.GetChannels(),
+                    image.GetLayout());
+  float *result_cells = result.GetData();
+  float *y_cells = y_sums.GetData();
+  ForEachPlaneRow(image, result, [&](const float* src, float* dst,
+      size_t rows, size_t width, size_t step, size_t row){
+    float *sums_x = dst + row * width;
+    float *sums_y = y_cells + (sums_x - result_cells);
+    ConvolveRow(sums_x, src, rows, width, step, row, sobel_x_kernel);
+    ConvolveRow(sums_y, src, rows, width, step, row, sobel_y_kernel);
+    for(size_t x = 0; x < width; ++x){
+      float cell = std::rintf(sums_x[x]) + std::rintf(sums_y[x]);
+      sums_x[x] = std::min(std::max(cell, (float)MIN_COLOR),
+                           (float)(MAX_COLOR - 1));
+    }
+  });
+  return result;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file ColorImage.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for ColorImage class (multi-channel image, interleaved or
+ * planar) and the channel-aware versions of the filters, which process all
+ * channels in one pass instead of filtering a Matrix per channel
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstddef>
+#include <vector>
+
+#ifndef EX5__COLOR_IMAGE_H_
+#define EX5__COLOR_IMAGE_H_
+#include "Matrix.h"
+
+/**
+ * COLOR_MAX_CHANNELS maximal amount of channels of a ColorImage (RGBA)
+ */
+#define COLOR_MAX_CHANNELS 4
+
+/**
+ * ChannelLayout order of the cells of a ColorImage:
+ * INTERLEAVED- pixel after pixel, the channels of a pixel next to each other
+ * (RGBRGB...)
+ * PLANAR- channel after channel, each channel a full rows x cols plane
+ * (RR...GG...BB...)
+ */
+enum ChannelLayout {INTERLEAVED, PLANAR};
+
+class ColorImage
+{
+  size_t _rows;
+  size_t _cols;
+  size_t _channels;
+  ChannelLayout _layout;
+  //interleaved: rows x (cols * channels), planar: (channels * rows) x cols
+  Matrix _data;
+
+  /**
+   * PRIVATE FUNCTION: position of a cell in _data (no range checks)
+   * @param row pixel's row
+   * @param col pixel's column
+   * @param channel channel of the pixel
+   * @return index of the cell
+   */
+  size_t GetOffset(size_t row, size_t col, size_t channel) const noexcept{
+    return _layout == INTERLEAVED ? (row * _cols + col) * _channels + channel
+                                  : (channel * _rows + row) * _cols + col;
+  }
+
+ public:
+
+  /**
+   * constructor for an all-zeros image
+   * @param rows number of rows (pixels)
+   * @param cols number of columns (pixels)
+   * @param channels channels per pixel, 1 to COLOR_MAX_CHANNELS
+   * @param layout order of the cells (INTERLEAVED by default)
+   */
+  ColorImage(size_t rows, size_t cols, size_t channels,
+             ChannelLayout layout = INTERLEAVED);
+
+  /**
+   * constructor merging one matrix per channel (e.g. R, G, B) into an image
+   * @param channels matrices of the same size, 1 to COLOR_MAX_CHANNELS
+   * @param layout order of the cells (INTERLEAVED by default)
+   */
+  explicit ColorImage(const std::vector<Matrix>& channels,
+                      ChannelLayout layout = INTERLEAVED);
+
+  /**
+   * getter for number of rows
+   * @return number of rows in image
+   */
+  size_t GetRows() const noexcept{
+    return _rows;
+  }
+
+  /**
+   * getter for number of columns
+   * @return number of columns in image
+   */
+  size_t GetCols() const noexcept{
+    return _cols;
+  }
+
+  /**
+   * getter for number of channels
+   * @return channels per pixel
+   */
+  size_t GetChannels() const noexcept{
+    return _channels;
+  }
+
+  /**
+   * getter for the layout
+   * @return INTERLEAVED or PLANAR
+   */
+  ChannelLayout GetLayout() const noexcept{
+    return _layout;
+  }
+
+  /**
+   * getter for the cells, in the order of the layout
+   * @return rows * cols * channels cells
+   */
+  float* GetData() noexcept{
+    return _data.GetMatrix();
+  }
+
+  /**
+   * getter for the cells, in the order of the layout
+   * @return rows * cols * channels cells
+   */
+  const float* GetData() const noexcept{
+    return _data.GetMatrix();
+  }
+
+  /**
+   * copies one channel out of the image
+   * @param channel channel to copy
+   * @return rows x cols matrix of the channel
+   */
+  Matrix GetChannel(size_t channel) const;
+
+  /**
+   * @param layout wanted layout
+   * @return copy of the image in the given layout
+   */
+  ColorImage ToLayout(ChannelLayout layout) const;
+
+  /**
+   * access to a cell by pixel and channel
+   * @param row pixel's row
+   * @param col pixel's column
+   * @param channel channel of the pixel
+   * @return reference to the cell
+   */
+  float& operator()(size_t row, size_t col, size_t channel);
+
+  /**
+   * access to a cell by pixel and channel
+   * @param row pixel's row
+   * @param col pixel's column
+   * @param channel channel of the pixel
+   * @return the cell's value
+   */
+  float operator()(size_t row, size_t col, size_t channel) const;
+};
+
+/**
+ * quantization filter on every channel of an image, same result as
+ * Quantization(const Matrix&, int) on each channel
+ * @param image image colors by numeric values
+ * @param levels number of levels we want to divide the colors by
+ * @return new image (same layout) which is the result of the process
+ */
+ColorImage Quantization(const ColorImage& image, int levels);
+
+/**
+ * Blur filter on every channel of an image in one pass over the cells (the
+ * inner loops run over all channels of a row, so they vectorize across
+ * channels), same result as Blur(const Matrix&) on each channel
+ * @param image image colors by numeric values
+ * @return new image (same layout) which is the result of the process
+ */
+ColorImage Blur(const ColorImage& image);
+
+/**
+ * Sobel filter on every channel of an image in one pass over the cells,
+ * same result as Sobel(const Matrix&) on each channel
+ * @param image image colors by numeric values
+ * @return new image (same layout) which is the result of the process
+ */
+ColorImage Sobel(const ColorImage& image);
+
+
+#endif //EX5__COLOR_IMAGE_H_
@@ -0,0 +1,439 @@
+/**
+ * @file Convolution.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for Convolution.h file
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "Convolution.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <new>
+#include <vector>
+
+/**
+ * ALLOC_FAIL_MSG message for MatrixException in case of a allocation failure
+ */
+#define ALLOC_FAIL_MSG "Allocation failed.\n"
+
+/**
+ * FFT_MIN_TILE smallest side of an overlap-add tile (smaller images are one
+ * tile)
+ */
+#define FFT_MIN_TILE 64
+
+/**
+ * FFT_TILE_FACTOR tile side in kernel sides: bigger tiles waste less of the
+ * FFT on the kernel overlap, smaller ones stay in cache
+ */
+#define FFT_TILE_FACTOR 4
+
+/**
+ * FFT_MAX_RADIX largest factor of an FFT size
+ */
+#define FFT_MAX_RADIX 5
+
+/**
+ * FFT_PHASES tile rows processed together are this many tile rows apart: a
+ * tile's output reaches into the tile rows above and below it, so tile rows
+ * 3 apart never write the same cells
+ */
+#define FFT_PHASES 3
+
+typedef std::complex<double> Complex;
+
+/**
+ * FftPlan mixed radix (4, 2, 3, 5) complex FFT of one size, recursive
+ * decimation in time with a shared twiddle table
+ */
+class FftPlan
+{
+ public:
+  /**
+   * prepares the factors and twiddles
+   * @param n transform size (only factors 2, 3 and 5, see SmoothSize)
+   */
+  explicit FftPlan(size_t n) : _n(n), _twiddles(n){
+    for(size_t j = 0; j < n; ++j){
+      double angle = -2 * M_PI * (double)j / (double)n;
+      _twiddles[j] = Complex(std::cos(angle), std::sin(angle));
+    }
+    while(n % 4 == 0){
+      _factors.push_back(4);
+      n /= 4;
+    }
+    for(size_t radix = 2; radix <= FFT_MAX_RADIX; ++radix){
+      while(n % radix == 0){
+        _factors.push_back(radix);
+        n /= radix;
+      }
+    }
+  }
+
+  /**
+   * in place transform (unnormalized: inverse(forward(x)) = n * x)
+   * @param data n values
+   * @param inverse true for the inverse transform
+   * @param scratch buffer of at least n values
+   */
+  void Transform(Complex* data, bool inverse, Complex* scratch) const{
+    Recurse(data, scratch, _n, 1, 0, inverse);
+    std::copy(scratch, scratch + _n, data);
+  }
+
+ private:
+  size_t _n;
+  std::vector<size_t> _factors;
+  //_twiddles[j] = exp(-2 pi i j / n)
+  std::vector<Complex> _twiddles;
+
+  /**
+   * @param index twiddle index (< n)
+   * @param inverse true for the inverse transform
+   * @return exp(-+2 pi i index / n)
+   */
+  Complex Twiddle(size_t index, bool inverse) const noexcept{
+    return inverse ? std::conj(_twiddles[index]) : _twiddles[index];
+  }
+
+  /**
+   * transforms n values read from in with the given stride into out
+   * @param in first input value
+   * @param out n contiguous output values
+   * @param n size of this sub transform
+   * @param stride input stride (= full size / n)
+   * @param factor_index first factor of n in _factors
+   * @param inverse true for the inverse transform
+   */
+  void Recurse(const Complex* in, Complex* out, size_t n, size_t stride,
+               size_t factor_index, bool inverse) const;
+};
+
+void FftPlan::Recurse(const Complex* in, Complex* out, size_t n,
+                      size_t stride, size_t factor_index,
+                      bool inverse) const{
+  if(n == 1){
+    out[0] = in[0];
+    return;
+  }
+  size_t radix = _factors[factor_index];
+  size_t m = n / radix;
+  for(size_t q = 0; q < radix; ++q){
+    Recurse(in + q * stride, out + q * m, m, stride * radix,
+            factor_index + 1, inverse);
+  }
+  //out[q * m + k] holds the m point transforms of the radix subsequences
+  if(radix == 2){
+    for(size_t k = 0; k < m; ++k){
+      Complex t = Twiddle(k * stride, inverse) * out[k + m];
+      out[k + m] = out[k] - t;
+      out[k] += t;
+    }
+  } else if(radix == 4){
+    Complex minus_i = inverse ? Complex(0, 1) : Complex(0, -1);
+    for(size_t k = 0; k < m; ++k){
+      Complex t0 = out[k];
+      Complex t1 = Twiddle(k * stride, inverse) * out[k + m];
+      Complex t2 = Twiddle(2 * k * stride, inverse) * out[k + 2 * m];
+      Complex t3 = Twiddle(3 * k * stride, inverse) * out[k + 3 * m];
+      Complex a0 = t0 + t2;
+      Complex a1 = t0 - t2;
+      Complex b0 = t1 + t3;
+      Complex b1 = (t1 - t3) * minus_i;
+      out[k] = a0 + b0;
+      out[k + m] = a1 + b1;
+      out[k + 2 * m] = a0 - b0;
+      out[k + 3 * m] = a1 - b1;
+    }
+  } else {
+    //radix 3 and 5: direct DFT of the radix values
+    Complex values[FFT_MAX_RADIX];
+    for(size_t k = 0; k < m; ++k){
+      for(size_t q = 0; q < radix; ++q){
+        values[q] = out[k + q * m];
+      }
+      for(size_t r = 0; r < radix; ++r){
+        size_t index = k + r * m;
+        Complex sum = values[0];
+        for(size_t q = 1; q < radix; ++q){
+          sum += values[q] * Twiddle((q * index * stride) % _n, inverse);
+        }
+        out[index] = sum;
+      }
+    }
+  }
+}
+
+/**
+ * @param n minimal size
+ * @return smallest size >= n with only the factors 2, 3 and 5
+ */
+static size_t SmoothSize(size_t n) noexcept{
+  for(;; ++n){
+    size_t rest = n;
+    for(size_t radix : {2, 3, 5}){
+      while(rest % radix == 0){
+        rest /= radix;
+      }
+    }
+    if(rest == 1){
+      return n;
+    }
+  }
+}
+
+/**
+ * FftWorkspace buffers of one worker: an rows x cols grid and the scratch
+ * space of the 1D transforms
+ */
+struct FftWorkspace
+{
+  std::vector<Complex> grid;
+  std::vector<Complex> scratch;
+  std::vector<Complex> column;
+
+  FftWorkspace(size_t rows, size_t cols)
+      : grid(rows * cols), scratch(std::max(rows, cols)), column(rows) {}
+};
+
+/**
+ * 2D transform of workspace.grid. the forward transform does the rows and
+ * then the columns, the inverse the columns and then the rows, so only
+ * used_rows rows need a row transform either way
+ * @param workspace grid to transform (row_plan size columns, col_plan size
+ * rows)
+ * @param row_plan plan of the row length
+ * @param col_plan plan of the column length
+ * @param rows amount of rows
+ * @param cols amount of columns
+ * @param used_rows forward: rows past this one are all zero. inverse: rows
+ * past this one are left partly transformed (not needed by the caller)
+ * @param inverse true for the inverse transform
+ */
+static void Transform2D(FftWorkspace& workspace, const FftPlan& row_plan,
+                        const FftPlan& col_plan, size_t rows, size_t cols,
+                        size_t used_rows, bool inverse){
+  Complex *grid = workspace.grid.data();
+  Complex *scratch = workspace.scratch.data();
+  Complex *column = workspace.column.data();
+  auto transform_rows = [&](){
+    for(size_t i = 0; i < used_rows; ++i){
+      row_plan.Transform(grid + i * cols, inverse, scratch);
+    }
+  };
+  if(!inverse){
+    transform_rows();
+  }
+  for(size_t j = 0; j < cols; ++j){
+    for(size_t i = 0; i < rows; ++i){
+      column[i] = grid[i * cols + j];
+    }
+    col_plan.Transform(column, inverse, scratch);
+    for(size_t i = 0; i < rows; ++i){
+      grid[i * cols + j] = column[i];
+    }
+  }
+  if(inverse){
+    transform_rows();
+  }
+}
+
+/**
+ * direct convolution: sum over the kernel for every cell, rows in parallel
+ * @param image source matrix
+ * @param kernel kernel
+ * @return the result
+ */
+static Matrix ConvolveDirect(const Matrix& image, const Matrix& kernel){
+  size_t rows = image.GetRows();
+  size_t cols = image.GetCols();
+  size_t kernel_rows = kernel.GetRows();
+  size_t kernel_cols = kernel.GetCols();
+  size_t center_row = kernel_rows / 2;
+  size_t center_col = kernel_cols / 2;
+  Matrix result(rows, cols);
+  const float *src = image.GetMatrix();
+  const float *weights = kernel.GetMatrix();
+  float *dst = result.GetMatrix();
+  ParallelRows(rows, cols, [&](size_t first, size_t last){
+    for(size_t r = first; r < last; ++r){
+      //kernel rows i with 0 <= r + i - center_row < rows
+      size_t first_i = center_row > r ? center_row - r : 0;
+      size_t last_i = std::min(kernel_rows, rows + center_row - r);
+      for(size_t c = 0; c < cols; ++c){
+        size_t first_j = center_col > c ? center_col - c : 0;
+        size_t last_j = std::min(kernel_cols, cols + center_col - c);
+        float sum = 0;
+        for(size_t i = first_i; i < last_i; ++i){
+          const float *src_row = src + (r + i - center_row) * cols +
+                                 (c - center_col);
+          const float *weight_row = weights + i * kernel_cols;
+          for(size_t j = first_j; j < last_j; ++j){
+            sum += weight_row[j] * src_row[j];
+          }
+        }
+        dst[r * cols + c] = sum;
+      }
+    }
+  });
+  return result;
+}
+
+/**
+ * FFT convolution with overlap-add: the image is cut in tiles, every tile
+ * pair (as the real and imaginary parts of one grid) is transformed,
+ * multiplied by the kernel spectrum and transformed back, and the full
+ * convolutions of the tiles are added into the result
+ * @param image source matrix
+ * @param kernel kernel
+ * @return the result
+ */
+static Matrix ConvolveFft(const Matrix& image, const Matrix& kernel){
+  size_t rows = image.GetRows();
+  size_t cols = image.GetCols();
+  size_t kernel_rows = kernel.GetRows();
+  size_t kernel_cols = kernel.GetCols();
+  //result(r, c) = full(r + offset_row, c + offset_col) of the convolution
+  //with the flipped kernel
+  size_t offset_row = kernel_rows - 1 - kernel_rows / 2;
+  size_t offset_col = kernel_cols - 1 - kernel_cols / 2;
+  size_t tile_rows = std::min(rows, std::max<size_t>(
+      FFT_MIN_TILE, FFT_TILE_FACTOR * kernel_rows));
+  size_t tile_cols = std::min(cols, std::max<size_t>(
+      FFT_MIN_TILE, FFT_TILE_FACTOR * kernel_cols));
+  size_t grid_rows = SmoothSize(tile_rows + kernel_rows - 1);
+  size_t grid_cols = SmoothSize(tile_cols + kernel_cols - 1);
+  FftPlan row_plan(grid_cols);
+  FftPlan col_plan(grid_rows);
+
+  FftWorkspace kernel_spectrum(grid_rows, grid_cols);
+  for(size_t i = 0; i < kernel_rows; ++i){
+    for(size_t j = 0; j < kernel_cols; ++j){
+      kernel_spectrum.grid[(kernel_rows - 1 - i) * grid_cols +
+                           (kernel_cols - 1 - j)] = kernel(i, j);
+    }
+  }
+  Transform2D(kernel_spectrum, row_plan, col_plan, grid_rows, grid_cols,
+              kernel_rows, false);
+  const Complex *spectrum = kernel_spectrum.grid.data();
+
+  Matrix result(rows, cols);
+  const float *src = image.GetMatrix();
+  float *dst = result.GetMatrix();
+  size_t tile_row_count = (rows + tile_rows - 1) / tile_rows;
+  size_t tile_col_count = (cols + tile_cols - 1) / tile_cols;
+  double scale = 1.0 / ((double)grid_rows * grid_cols);
+  size_t full_rows = tile_rows + kernel_rows - 1;
+
+  //adds the full convolution of the tile at (first_row, first_col) of size
+  //height x width, stored in the real or imaginary part of the grid, to the
+  //result
+  auto accumulate = [&](const Complex *grid, size_t first_row,
+      size_t first_col, size_t height, size_t width, bool imaginary){
+    for(size_t u = 0; u < height + kernel_rows - 1; ++u){
+      if(first_row + u < offset_row || first_row + u - offset_row >= rows){
+        continue;
+      }
+      float *dst_row = dst + (first_row + u - offset_row) * cols;
+      const Complex *grid_row = grid + u * grid_cols;
+      for(size_t v = 0; v < width + kernel_cols - 1; ++v){
+        if(first_col + v < offset_col || first_col + v - offset_col >= cols){
+          continue;
+        }
+        double value = imaginary ? grid_row[v].imag() : grid_row[v].real();
+        dst_row[first_col + v - offset_col] += (float)(value * scale);
+      }
+    }
+  };
+
+  //ParallelRows must not throw: a worker that fails to allocate its
+  //workspace only marks it, and the failure is thrown once the phase ends
+  std::atomic<bool> alloc_failed(false);
+  for(size_t phase = 0; phase < FFT_PHASES; ++phase){
+    size_t units = tile_row_count > phase ?
+                   (tile_row_count - phase + FFT_PHASES - 1) / FFT_PHASES : 0;
+    ParallelRows(units, tile_rows * cols, [&](size_t first, size_t last){
+      try{
+        FftWorkspace workspace(grid_rows, grid_cols);
+        Complex *grid = workspace.grid.data();
+        for(size_t unit = first; unit < last; ++unit){
+          size_t first_row = (unit * FFT_PHASES + phase) * tile_rows;
+          size_t height = std::min(tile_rows, rows - first_row);
+          for(size_t tile = 0; tile < tile_col_count; tile += 2){
+            size_t first_col = tile * tile_cols;
+            size_t width = std::min(tile_cols, cols - first_col);
+            bool has_pair = tile + 1 < tile_col_count;
+            size_t pair_col = first_col + tile_cols;
+            size_t pair_width = has_pair ? std::min(tile_cols,
+                                                    cols - pair_col) : 0;
+            std::fill(workspace.grid.begin(), workspace.grid.end(),
+                      Complex(0, 0));
+            for(size_t i = 0; i < height; ++i){
+              const float *src_row = src + (first_row + i) * cols;
+              Complex *grid_row = grid + i * grid_cols;
+              for(size_t j = 0; j < width; ++j){
+                grid_row[j] = Complex(src_row[first_col + j], 0);
+              }
+              for(size_t j = 0; j < pair_width; ++j){
+                grid_row[j].imag(src_row[pair_col + j]);
+              }
+            }
+            Transform2D(workspace, row_plan, col_plan, grid_rows, grid_cols,
+                        height, false);
+            for(size_t i = 0; i < grid_rows * grid_cols; ++i){
+              grid[i] *= spectrum[i];
+            }
+            //the kernel is real: the real and imaginary parts of the product
+            //stay the convolutions of the two tiles
+            Transform2D(workspace, row_plan, col_plan, grid_rows, grid_cols,
+                        std::min(grid_rows, full_rows), true);
+            accumulate(grid, first_row, first_col, height, width, false);
+            if(has_pair){
+              accumulate(grid, first_row, pair_col, height, pair_width, true);
+            }
+          }
+        }
+      }catch(const std::bad_alloc&){
+        alloc_failed.store(true, std::memory_order_relaxed);
+      }
+    });
+    if(alloc_failed.load(std::memory_order_relaxed)){
+      throw MatrixException(ALLOC_FAIL_MSG);
+    }
+  }
+  return result;
+}
+
+/**
+ * @param kernel convolution kernel
+ * @return the method CONVOLUTION_AUTO picks for kernel
+ */
+ConvolutionMethod ChooseConvolutionMethod(const Matrix& kernel) noexcept{
+  return kernel.GetRows() > FFT_KERNEL_THRESHOLD ||
+         kernel.GetCols() > FFT_KERNEL_THRESHOLD ? CONVOLUTION_FFT :
+         CONVOLUTION_DIRECT;
+}
+
+/**
+ * convolution of image with a kernel of any size
+ * @param image source matrix
+ * @param kernel kernel of any size
+ * @param method direct, FFT or chosen by kernel size
+ * @return new matrix of image's size with the result
+ */
+Matrix Convolve(const Matrix& image, const Matrix& kernel,
+                ConvolutionMethod method){
+  if(method == CONVOLUTION_AUTO){
+    method = ChooseConvolutionMethod(kernel);
+  }
+  if(method == CONVOLUTION_FFT){
+    return ConvolveFft(image, kernel);
+  }
+  return ConvolveDirect(image, kernel);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file Convolution.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for convolution of a Matrix with a kernel of any size, with
+ * a direct path and an FFT (overlap-add) path for large kernels
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "Matrix.h"
+#include <cstddef>
+
+#ifndef EX5__CONVOLUTION_H_
+#define EX5__CONVOLUTION_H_
+
+/**
+ * FFT_KERNEL_THRESHOLD CONVOLUTION_AUTO uses the FFT path when the kernel
+ * has more rows or columns than this
+ */
+#define FFT_KERNEL_THRESHOLD 15
+
+/**
+ * FFT_TOLERANCE the FFT path matches the direct path up to
+ * FFT_TOLERANCE * max|image cell| * sum|kernel cell| per cell (the FFT runs
+ * in double; the difference is dominated by the float rounding of the
+ * direct path)
+ */
+#define FFT_TOLERANCE 1e-5
+
+/**
+ * ConvolutionMethod how Convolve computes the result:
+ * CONVOLUTION_AUTO- FFT if the kernel is larger than FFT_KERNEL_THRESHOLD in
+ * any dimension, direct otherwise
+ * CONVOLUTION_DIRECT- sum over the kernel for every cell, O(k^2) per cell
+ * CONVOLUTION_FFT- overlap-add of FFT products over tiles of the image,
+ * O(log) per cell for any kernel size
+ */
+enum ConvolutionMethod {CONVOLUTION_AUTO, CONVOLUTION_DIRECT, CONVOLUTION_FFT};
+
+/**
+ * @param kernel convolution kernel
+ * @return the method CONVOLUTION_AUTO picks for kernel
+ */
+ConvolutionMethod ChooseConvolutionMethod(const Matrix& kernel) noexcept;
+
+/**
+ * convolution in the same convention as MatrixConvolution of Filters.cc:
+ * cell (r, c) of the result is the sum of kernel(i, j) *
+ * image(r + i - kernel rows / 2, c + j - kernel cols / 2), cells outside the
+ * image count as 0. unlike the filters the result isn't rounded
+ * @param image source matrix
+ * @param kernel kernel of any size
+ * @param method direct, FFT or chosen by kernel size
+ * @return new matrix of image's size with the result
+ */
+Matrix Convolve(const Matrix& image, const Matrix& kernel,
+                ConvolutionMethod method = CONVOLUTION_AUTO);
+
+
+#endif //EX5__CONVOLUTION_H_
@@ -9,7 +9,11 @@
  */
 
 #include "Filters.h"
+#include "MatrixProfiler.h"
+#include "Parallel.h"
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 
 /**
  * MAX_COLOR maximum color value
@@ -84,8 +88,8 @@ void MatrixConvolution(Matrix &to_update, const Matrix &original_matrix,
  * @param conv_mat matrix for the convolution operation
  * @return value of the process's result
  */
-float CellConvolution(int row, int col, const Matrix &matrix, const Matrix
-&conv_mat) noexcept;
+float CellConvolution(size_t row, size_t col, const Matrix &matrix, const
+Matrix &conv_mat) noexcept;
 
 /**
  * preforming quantization filter on a given matrix
@@ -94,17 +98,25 @@ float CellConvolution(int row, int col, const Matrix &matrix, const Matrix
  * @return new matrix which is the result of the process
  */
 Matrix Quantization(const Matrix& image, int levels){
+  MATRIX_PROFILE_SCOPE(PROFILE_QUANTIZATION,
+                       2 * image.GetRows() * image.GetCols() * sizeof(float));
   int colors_in_level = MAX_COLOR / levels;
   Matrix new_mat(image.GetRows(), image.GetCols());
   int *avg_array = GetAverages(levels, colors_in_level);
   if(avg_array == nullptr){
     throw MatrixException(ALLOC_FAIL_MSG);
   }
-  int cell_amount = image.GetRows() * image.GetCols();
-  for(int i = 0; i < cell_amount; ++i){
-    int avg_index = std::floor(image[i] / (float)colors_in_level);
-    new_mat[i] = (float)avg_array[avg_index];
-  }
+  size_t cols = image.GetCols();
+  const float *src = image.GetMatrix();
+  float *dst = new_mat.GetMatrix();
+  ParallelRows(image.GetRows(), cols, [&](size_t first, size_t last){
+    for(size_t i = first * cols; i < last * cols; ++i){
+      //the colors above levels * colors_in_level belong to the last level
+      int avg_index = std::min((int)std::floor(src[i] /
+                               (float)colors_in_level), levels - 1);
+      dst[i] = (float)avg_array[avg_index];
+    }
+  });
   delete[] avg_array;
   return new_mat;
 }
@@ -130,6 +142,8 @@ int *GetAverages(const int levels, const int colors_in_level) noexcept{
  * @return new matrix which is the result of the process
  */
 Matrix Blur(const Matrix& image){
+  MATRIX_PROFILE_SCOPE(PROFILE_BLUR,
+                       2 * image.GetRows() * image.GetCols() * sizeof(float));
   Matrix blurred(image.GetRows(), image.GetCols());
   Matrix blur_matrix = CreateConvolutionMatrix(BLUR_MATRIX_DATA);
   MatrixConvolution(blurred, image, blur_matrix);
@@ -142,7 +156,7 @@ Matrix Blur(const Matrix& image){
 Matrix CreateConvolutionMatrix(const std::string& data) {
   Matrix conv_matrix(CONVOLUTION_MATRIX_SIZE, CONVOLUTION_MATRIX_SIZE);
   std::string number;
-  int counter = 0;
+  size_t counter = 0;
   for(auto c: data){
     if(c == ' '){
       conv_matrix[counter++] = std::stof(number);
@@ -159,26 +173,35 @@ Matrix CreateConvolutionMatrix(const std::string& data) {
  */
 void MatrixConvolution(Matrix &to_update,const Matrix &original_matrix, const
 Matrix &conv_mat) noexcept{
-  for(int i = 0; i < to_update.GetRows(); ++i){
-    for(int j = 0; j < to_update.GetCols(); ++j){
-      to_update(i,j) = CellConvolution(i, j, original_matrix, conv_mat);
+  MATRIX_PROFILE_SCOPE(PROFILE_CONVOLUTION, 2 * to_update.GetRows() *
+                       to_update.GetCols() * sizeof(float));
+  size_t cols = to_update.GetCols();
+  float *dst = to_update.GetMatrix();
+  ParallelRows(to_update.GetRows(), cols, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      for(size_t j = 0; j < cols; ++j){
+        dst[i * cols + j] = CellConvolution(i, j, original_matrix, conv_mat);
+      }
     }
-  }
+  });
 }
 
 /**
  * documentation above
  */
-float CellConvolution(int row, int col, const Matrix &matrix, const Matrix
-&conv_mat) noexcept{
+float CellConvolution(size_t row, size_t col, const Matrix &matrix, const
+Matrix &conv_mat) noexcept{
   float result = 0;
-  for(int i = 0; i < 3; ++i){
-    for(int j = 0; j < 3; ++j){
-      if(row + i - 1 < 0 || row + i - 1 >=matrix.GetRows() || col + j - 1 < 0
-      || col + j - 1 >= matrix.GetCols()){
+  auto rows = (ptrdiff_t)matrix.GetRows();
+  auto cols = (ptrdiff_t)matrix.GetCols();
+  for(ptrdiff_t i = 0; i < 3; ++i){
+    for(ptrdiff_t j = 0; j < 3; ++j){
+      ptrdiff_t src_row = (ptrdiff_t)row + i - 1;
+      ptrdiff_t src_col = (ptrdiff_t)col + j - 1;
+      if(src_row < 0 || src_row >= rows || src_col < 0 || src_col >= cols){
         continue;
       }
-      result += conv_mat(i,j) * matrix(row + i - 1, col + j - 1);
+      result += conv_mat(i,j) * matrix(src_row, src_col);
     }
   }
   return std::rintf(result);
@@ -190,6 +213,8 @@ float CellConvolution(int row, int col, const Matrix &matrix, const Matrix
  * @return new matrix which is the result of the process
  */
 Matrix Sobel(const Matrix& image){
+  MATRIX_PROFILE_SCOPE(PROFILE_SOBEL,
+                       2 * image.GetRows() * image.GetCols() * sizeof(float));
   Matrix sobel_x(image.GetRows(), image.GetCols());
   Matrix sobel_y(image.GetRows(), image.GetCols());
   Matrix conv_x = CreateConvolutionMatrix(SOBEL_X_MATRIX_DATA);
@@ -197,13 +222,18 @@ Matrix Sobel(const Matrix& image){
   MatrixConvolution(sobel_x, image, conv_x);
   MatrixConvolution(sobel_y, image, conv_y);
   Matrix result = sobel_x + sobel_y;
-  for(int i = 0; i < result.GetRows() * result.GetCols(); ++i){
-    if(result[i] < MIN_COLOR){
-      result[i] = MIN_COLOR;
-    }
-    if(result[i] >= MAX_COLOR){
-      result[i] = MAX_COLOR - 1;
+  size_t cols = result.GetCols();
+  float *cells = result.GetMatrix();
+  ParallelRows(result.GetRows(), cols, [cells, cols](size_t first,
+      size_t last){
+    for(size_t i = first * cols; i < last * cols; ++i){
+      if(cells[i] < MIN_COLOR){
+        cells[i] = MIN_COLOR;
+      }
+      if(cells[i] >= MAX_COLOR){
+        cells[i] = MAX_COLOR - 1;
+      }
     }
-  }
+  });
   return result;
 }
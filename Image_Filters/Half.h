@@ -0,0 +1,124 @@
+/**
+ * @file Half.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for Half: 16 bit (IEEE binary16) storage type for matrices
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#ifndef EX5__HALF_H_
+#define EX5__HALF_H_
+
+/**
+ * Half stores a float in 16 bits (1 sign, 5 exponent, 10 mantissa bits).
+ * it is a storage type only: every arithmetic operation converts it to
+ * float, computes in float and rounds back (round to nearest even)
+ */
+class Half
+{
+  uint16_t _bits;
+
+  /**
+   * converting float to binary16 bits with round to nearest even.
+   * overflow gives infinity, NaN stays NaN
+   * @param value float to convert
+   * @return binary16 bits
+   */
+  static uint16_t FromFloat(float value) noexcept{
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    uint32_t sign = (f >> 16) & 0x8000u;
+    uint32_t abs = f & 0x7fffffffu;
+    if(abs >= 0x7f800000u){ //inf or NaN
+      return (uint16_t)(sign | 0x7c00u | (abs > 0x7f800000u ? 0x200u : 0u));
+    }
+    if(abs >= 0x477ff000u){ //rounds above the largest half (65504)
+      return (uint16_t)(sign | 0x7c00u);
+    }
+    if(abs < 0x38800000u){ //subnormal half (or zero)
+      if(abs < 0x33000000u){
+        return (uint16_t)sign;
+      }
+      uint32_t shift = 113 - (abs >> 23);
+      uint32_t mantissa = (abs & 0x7fffffu) | 0x800000u;
+      uint32_t half_bits = mantissa >> (shift + 13);
+      uint32_t rest = mantissa & ((1u << (shift + 13)) - 1);
+      uint32_t halfway = 1u << (shift + 12);
+      if(rest > halfway || (rest == halfway && (half_bits & 1u))){
+        half_bits++;
+      }
+      return (uint16_t)(sign | half_bits);
+    }
+    uint32_t half_bits = ((abs >> 13) - (112u << 10));
+    uint32_t rest = abs & 0x1fffu;
+    if(rest > 0x1000u || (rest == 0x1000u && (half_bits & 1u))){
+      half_bits++;
+    }
+    return (uint16_t)(sign | half_bits);
+  }
+
+  /**
+   * converting binary16 bits to float (exact)
+   * @param bits binary16 bits
+   * @return float with the same value
+   */
+  static float ToFloat(uint16_t bits) noexcept{
+    uint32_t sign = (uint32_t)(bits & 0x8000u) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1fu;
+    uint32_t mantissa = bits & 0x3ffu;
+    uint32_t f;
+    if(exponent == 0x1fu){
+      f = sign | 0x7f800000u | (mantissa << 13);
+    }else if(exponent != 0){
+      f = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }else if(mantissa == 0){
+      f = sign;
+    }else{ //subnormal half is a normal float
+      exponent = 113;
+      while(!(mantissa & 0x400u)){
+        mantissa <<= 1;
+        exponent--;
+      }
+      f = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+    }
+    float value;
+    std::memcpy(&value, &f, sizeof(value));
+    return value;
+  }
+
+ public:
+
+  /**
+   * default constructor initiating half with the value 0
+   */
+  Half() noexcept: _bits(0) {}
+
+  /**
+   * constructor rounding a float into half precision
+   * @param value float value to store
+   */
+  Half(float value) noexcept: _bits(FromFloat(value)) {}
+
+  /**
+   * @return stored value as float
+   */
+  operator float() const noexcept{
+    return ToFloat(_bits);
+  }
+
+  /**
+   * getter for the raw binary16 bits
+   * @return _bits
+   */
+  uint16_t GetBits() const noexcept{
+    return _bits;
+  }
+};
+
+
+#endif //EX5__HALF_H_
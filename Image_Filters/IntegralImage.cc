@@ -0,0 +1,215 @@
+/**
+ * @file IntegralImage.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for IntegralImage.h file
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "IntegralImage.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * THRESHOLD_WHITE value of cells above the threshold
+ */
+#define THRESHOLD_WHITE 255
+
+/**
+ * THRESHOLD_BLACK value of cells below the threshold
+ */
+#define THRESHOLD_BLACK 0
+
+/**
+ * builds the integral image of image's cells, each mapped through value()
+ * @param image source matrix
+ * @param value cell -> value to sum
+ * @return the (rows + 1) x (cols + 1) integral image
+ */
+template<typename Value>
+static DoubleMatrix BuildIntegral(const Matrix& image, Value value){
+  size_t rows = image.GetRows();
+  size_t cols = image.GetCols();
+  size_t width = cols + 1;
+  DoubleMatrix integral(rows + 1, width);
+  const float *src = image.GetMatrix();
+  double *dst = integral.GetMatrix();
+  //prefix sums along every row (row i of image goes to row i + 1)
+  ParallelRows(rows, cols, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      const float *src_row = src + i * cols;
+      double *dst_row = dst + (i + 1) * width;
+      double sum = 0;
+      for(size_t j = 0; j < cols; ++j){
+        sum += value(src_row[j]);
+        dst_row[j + 1] = sum;
+      }
+    }
+  });
+  //prefix sums down every column: the partition is over columns, and each
+  //worker walks its column range row by row (contiguous memory)
+  ParallelRows(width, rows, [&](size_t first, size_t last){
+    for(size_t i = 1; i <= rows; ++i){
+      const double *above = dst + (i - 1) * width;
+      double *row = dst + i * width;
+      for(size_t j = first; j < last; ++j){
+        row[j] += above[j];
+      }
+    }
+  });
+  return integral;
+}
+
+/**
+ * runs func(row, col, first_row, first_col, last_row, last_col) for every
+ * cell of a rows x cols matrix with the bounds of its clipped window, rows
+ * in parallel
+ * @param rows amount of rows
+ * @param cols amount of columns
+ * @param radius window radius
+ * @param func called for every cell
+ */
+template<typename Func>
+static void ForEachWindow(size_t rows, size_t cols, size_t radius,
+                          Func func){
+  ParallelRows(rows, cols, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      size_t first_row = i > radius ? i - radius : 0;
+      //rows - i > radius instead of i + radius + 1 < rows, which wraps
+      //around for huge radii
+      size_t last_row = rows - i > radius ? i + radius + 1 : rows;
+      for(size_t j = 0; j < cols; ++j){
+        size_t first_col = j > radius ? j - radius : 0;
+        size_t last_col = cols - j > radius ? j + radius + 1 : cols;
+        func(i, j, first_row, first_col, last_row, last_col);
+      }
+    }
+  });
+}
+
+/**
+ * @param image source matrix
+ * @return the integral image
+ */
+DoubleMatrix IntegralImage(const Matrix& image){
+  return BuildIntegral(image, [](float cell){ return (double)cell; });
+}
+
+/**
+ * @param image source matrix
+ * @return the integral image of the squares
+ */
+DoubleMatrix SquaredIntegralImage(const Matrix& image){
+  return BuildIntegral(image, [](float cell){
+    return (double)cell * (double)cell;
+  });
+}
+
+/**
+ * sum of the image cells in a box in O(1)
+ * @param integral integral image
+ * @param first_row first row of the box
+ * @param first_col first column of the box
+ * @param last_row one past the last row of the box
+ * @param last_col one past the last column of the box
+ * @return sum of the box
+ */
+double BoxSum(const DoubleMatrix& integral, size_t first_row,
+              size_t first_col, size_t last_row, size_t last_col) noexcept{
+  size_t width = integral.GetCols();
+  const double *cells = integral.GetMatrix();
+  return cells[last_row * width + last_col] -
+         cells[first_row * width + last_col] -
+         cells[last_row * width + first_col] +
+         cells[first_row * width + first_col];
+}
+
+/**
+ * box blur: rounded mean of the window around every cell
+ * @param image matrix representing image by numeric values
+ * @param radius window radius
+ * @return new matrix which is the result of the process
+ */
+Matrix BoxBlur(const Matrix& image, size_t radius){
+  Matrix blurred = LocalMean(image, radius);
+  float *cells = blurred.GetMatrix();
+  size_t cols = blurred.GetCols();
+  ParallelRows(blurred.GetRows(), cols, [cells, cols](size_t first,
+      size_t last){
+    for(size_t i = first * cols; i < last * cols; ++i){
+      cells[i] = std::rint(cells[i]);
+    }
+  });
+  return blurred;
+}
+
+/**
+ * @param image source matrix
+ * @param radius window radius
+ * @return the mean of the window around every cell
+ */
+Matrix LocalMean(const Matrix& image, size_t radius){
+  DoubleMatrix integral = IntegralImage(image);
+  size_t cols = image.GetCols();
+  Matrix mean(image.GetRows(), cols);
+  float *dst = mean.GetMatrix();
+  ForEachWindow(image.GetRows(), cols, radius, [&](size_t i, size_t j,
+      size_t first_row, size_t first_col, size_t last_row, size_t last_col){
+    double count = (double)(last_row - first_row) * (last_col - first_col);
+    dst[i * cols + j] = (float)(BoxSum(integral, first_row, first_col,
+                                       last_row, last_col) / count);
+  });
+  return mean;
+}
+
+/**
+ * @param image source matrix
+ * @param radius window radius
+ * @return the standard deviation of the window around every cell
+ */
+Matrix LocalStdDev(const Matrix& image, size_t radius){
+  DoubleMatrix integral = IntegralImage(image);
+  DoubleMatrix squares = SquaredIntegralImage(image);
+  size_t cols = image.GetCols();
+  Matrix deviation(image.GetRows(), cols);
+  float *dst = deviation.GetMatrix();
+  ForEachWindow(image.GetRows(), cols, radius, [&](size_t i, size_t j,
+      size_t first_row, size_t first_col, size_t last_row, size_t last_col){
+    double count = (double)(last_row - first_row) * (last_col - first_col);
+    double mean = BoxSum(integral, first_row, first_col, last_row,
+                         last_col) / count;
+    double mean_square = BoxSum(squares, first_row, first_col, last_row,
+                                last_col) / count;
+    //E[x^2] - E[x]^2 may come out slightly negative from rounding
+    dst[i * cols + j] = (float)std::sqrt(std::max(0.0, mean_square -
+                                                       mean * mean));
+  });
+  return deviation;
+}
+
+/**
+ * local mean (adaptive) threshold
+ * @param image matrix representing image by numeric values
+ * @param radius window radius
+ * @param offset subtracted from the local mean
+ * @return new matrix which is the result of the process
+ */
+Matrix LocalMeanThreshold(const Matrix& image, size_t radius, float offset){
+  DoubleMatrix integral = IntegralImage(image);
+  size_t cols = image.GetCols();
+  Matrix result(image.GetRows(), cols);
+  const float *src = image.GetMatrix();
+  float *dst = result.GetMatrix();
+  ForEachWindow(image.GetRows(), cols, radius, [&](size_t i, size_t j,
+      size_t first_row, size_t first_col, size_t last_row, size_t last_col){
+    double count = (double)(last_row - first_row) * (last_col - first_col);
+    double mean = BoxSum(integral, first_row, first_col, last_row,
+                         last_col) / count;
+    dst[i * cols + j] = src[i * cols + j] > mean - offset ?
+                        THRESHOLD_WHITE : THRESHOLD_BLACK;
+  });
+  return result;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file IntegralImage.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for integral images (summed-area tables) and the box
+ * filters / local statistics built on them, whose cost per pixel doesn't
+ * depend on the window size
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "Matrix.h"
+#include <cstddef>
+
+#ifndef EX5__INTEGRAL_IMAGE_H_
+#define EX5__INTEGRAL_IMAGE_H_
+
+/**
+ * builds the integral image of image: a (rows + 1) x (cols + 1) matrix whose
+ * cell (i, j) is the sum of image's cells above and left of (i, j), so row 0
+ * and column 0 are zero. prefix sums are done in double, rows in parallel
+ * and then columns in parallel
+ * @param image source matrix
+ * @return the integral image
+ */
+DoubleMatrix IntegralImage(const Matrix& image);
+
+/**
+ * same as IntegralImage, for the squares of image's cells (for local
+ * variance)
+ * @param image source matrix
+ * @return the integral image of the squares
+ */
+DoubleMatrix SquaredIntegralImage(const Matrix& image);
+
+/**
+ * sum of the image cells in rows [first_row, last_row) and columns
+ * [first_col, last_col) in O(1) (no range checks)
+ * @param integral integral image (IntegralImage or SquaredIntegralImage)
+ * @param first_row first row of the box
+ * @param first_col first column of the box
+ * @param last_row one past the last row of the box (<= image rows)
+ * @param last_col one past the last column of the box (<= image columns)
+ * @return sum of the box
+ */
+double BoxSum(const DoubleMatrix& integral, size_t first_row,
+              size_t first_col, size_t last_row, size_t last_col) noexcept;
+
+/**
+ * box blur: every cell becomes the rounded mean of the (2 * radius + 1)^2
+ * window around it (clipped at the borders, averaging the cells inside)
+ * @param image matrix representing image by numeric values
+ * @param radius window radius (0 returns a rounded copy)
+ * @return new matrix which is the result of the process
+ */
+Matrix BoxBlur(const Matrix& image, size_t radius);
+
+/**
+ * @param image source matrix
+ * @param radius window radius (windows are clipped at the borders)
+ * @return the mean of the window around every cell
+ */
+Matrix LocalMean(const Matrix& image, size_t radius);
+
+/**
+ * @param image source matrix
+ * @param radius window radius (windows are clipped at the borders)
+ * @return the standard deviation of the window around every cell
+ */
+Matrix LocalStdDev(const Matrix& image, size_t radius);
+
+/**
+ * local mean (adaptive) threshold: a cell becomes white (255) if it is
+ * greater than the mean of its window minus offset, black (0) otherwise
+ * @param image matrix representing image by numeric values
+ * @param radius window radius (windows are clipped at the borders)
+ * @param offset subtracted from the local mean
+ * @return new matrix which is the result of the process
+ */
+Matrix LocalMeanThreshold(const Matrix& image, size_t radius, float offset);
+
+
+#endif //EX5__INTEGRAL_IMAGE_H_
@@ -9,6 +9,12 @@
  */
 
 #include "Matrix.h"
+#include "MatrixAllocator.h"
+#include "MatrixProfiler.h"
+#include "MatrixTrace.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdint>
 
 /**
  * MATRIX_DIMENSION_ERROR_MSG message for MatrixException in case of invalid
@@ -50,33 +56,29 @@
  * @param rows number of rows for the Matrix
  * @param cols number of columns for the Matrix
  */
-Matrix::Matrix(int rows, int cols) {
-  if(rows <=0 || cols <=0){
-    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
-  }
-  try{
-    _matrix = new float[rows * cols];
-  }catch(const std::bad_alloc& err){
-    throw MatrixException(ALLOC_FAIL_MSG);
-  }
-
-  for(int i = 0; i < rows * cols; ++i){
-    _matrix[i] = MATRIX_INITIAL_VALUE;
-  }
+template<typename T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols) {
+  size_t cell_amount = CheckedCellAmount(rows, cols);
+  _matrix = AllocateCells(cell_amount);
+  MATRIX_TRACE_ALLOCATION(_matrix, cell_amount * sizeof(T), TRACE_CONSTRUCT,
+                          nullptr);
+
+  ParallelRows(rows, cols, [this, cols](size_t first, size_t last){
+    std::fill(_matrix + first * cols, _matrix + last * cols,
+              (T)MATRIX_INITIAL_VALUE);
+  });
   _rows = rows;
   _cols = cols;
-  _cell_amount = _rows * _cols;
+  _cell_amount = cell_amount;
 }
 
 /**
  * default constructor initiating new Matrix in size of 1*1
  */
-Matrix::Matrix() {
-  try{
-    _matrix = new float[1];
-  }catch(const std::bad_alloc& err){
-    throw MatrixException(ALLOC_FAIL_MSG);
-  }
+template<typename T>
+BasicMatrix<T>::BasicMatrix() {
+  _matrix = AllocateCells(1);
+  MATRIX_TRACE_ALLOCATION(_matrix, sizeof(T), TRACE_CONSTRUCT, nullptr);
   _matrix[0] = MATRIX_INITIAL_VALUE;
   _rows = 1;
   _cols = 1;
@@ -87,35 +89,38 @@ Matrix::Matrix() {
  * copy constructor creating new Matrix using other given Matrix
  * @param m given Matrix to create from
  */
-Matrix::Matrix(const Matrix &m) {
+template<typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &m) {
   //no need to check rows,cols > 0
   if(this != &m){
-    try{
-      _matrix = new float[m._rows * m._cols];
-    }catch(const std::bad_alloc &err){
-      throw MatrixException(ALLOC_FAIL_MSG);
-    }
+    MATRIX_PROFILE_SCOPE(PROFILE_COPY, 2 * m._cell_amount * sizeof(T));
+    _matrix = AllocateCells(m._cell_amount);
+    MATRIX_TRACE_ALLOCATION(_matrix, m._cell_amount * sizeof(T), TRACE_COPY,
+                            m._matrix);
     _rows = m._rows;
     _cols = m._cols;
-    _cell_amount = m._rows * m._cols;
-    for(int idx = 0; idx < _rows * _cols; idx++){
-      this->_matrix[idx] = m._matrix[idx];
-    }
+    _cell_amount = m._cell_amount;
+    ParallelRows(_rows, _cols, [this, &m](size_t first, size_t last){
+      std::copy(m._matrix + first * _cols, m._matrix + last * _cols,
+                _matrix + first * _cols);
+    });
   }
 }
 
 /**
  * destructor for Matrix object
  */
-Matrix:: ~Matrix() {
-  delete[] _matrix;
+template<typename T>
+BasicMatrix<T>:: ~BasicMatrix() {
+  FreeCells(_matrix);
 }
 
 /**
  * getter for matrix._rows
  * @return number of rows in matrix
  */
-int Matrix::GetRows() const noexcept{
+template<typename T>
+size_t BasicMatrix<T>::GetRows() const noexcept{
   return this->_rows;
 }
 
@@ -123,17 +128,36 @@ int Matrix::GetRows() const noexcept{
  * getter for matrix._cols
  * @return number of columns in matrix
  */
-int Matrix::GetCols() const noexcept {
+template<typename T>
+size_t BasicMatrix<T>::GetCols() const noexcept {
   return this->_cols;
 }
 
+/**
+ * getter for the raw cells buffer (row-major, _rows*_cols cells)
+ * @return pointer to the first cell of the matrix
+ */
+template<typename T>
+T* BasicMatrix<T>::GetMatrix() noexcept{
+  return _matrix;
+}
+
+/**
+ * getter for the raw cells buffer of a const matrix
+ * @return const pointer to the first cell of the matrix
+ */
+template<typename T>
+const T* BasicMatrix<T>::GetMatrix() const noexcept{
+  return _matrix;
+}
 
 /**
  * transforms a matrix into column vector.
  * IMPORTANT: when activated this action is irreversible due to chane in
  * dimensions
  */
-Matrix& Matrix::Vectorize() noexcept{
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::Vectorize() noexcept{
   _rows = _rows * _cols;
   _cols = 1;
   return *this;
@@ -145,22 +169,22 @@ Matrix& Matrix::Vectorize() noexcept{
  * called this operator at
  * @return reference to the Matrix we called the operator at after updating
  */
-Matrix& Matrix::operator=(const Matrix& other){
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const BasicMatrix& other){
   if(this != &other){
-    float* tmp_mat = nullptr;
-    try{
-      tmp_mat = new float[other._rows * other._cols];
-    }catch(const std::bad_alloc &err){
-      throw MatrixException(ALLOC_FAIL_MSG);
-    }
+    MATRIX_PROFILE_SCOPE(PROFILE_COPY, 2 * other._cell_amount * sizeof(T));
+    T* tmp_mat = AllocateCells(other._cell_amount);
+    MATRIX_TRACE_ALLOCATION(tmp_mat, other._cell_amount * sizeof(T),
+                            TRACE_ASSIGN, other._matrix);
     _cols = other._cols;
     _rows = other._rows;
     _cell_amount = other._cell_amount;
-    delete[] _matrix;
+    FreeCells(_matrix);
     _matrix = tmp_mat;
-    for(int i = 0; i < _rows * _cols; ++i){
-      _matrix[i] = other._matrix[i];
-    }
+    ParallelRows(_rows, _cols, [this, &other](size_t first, size_t last){
+      std::copy(other._matrix + first * _cols, other._matrix + last * _cols,
+                _matrix + first * _cols);
+    });
   }
   return *this;
 }
@@ -171,17 +195,22 @@ Matrix& Matrix::operator=(const Matrix& other){
  * dimensions are valid
  * @return new Matrix object whis is the result of the Matrices multiplication
  */
-Matrix Matrix::operator*(const Matrix& other) const{
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix& other) const{
   if(_cols != other._rows){
     throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
   }
-  Matrix new_mat(_rows, other._cols);
-  for(int i = 0; i < new_mat._rows; ++i){
-    for(int j = 0; j < new_mat._cols; ++j){
-      new_mat._matrix[i * new_mat._cols + j] = CalculateCell(*this, other,
-                                                             i, j, _cols);
+  MATRIX_PROFILE_SCOPE(PROFILE_MATRIX_MUL, (_cell_amount + other._cell_amount +
+                       _rows * other._cols) * sizeof(T));
+  BasicMatrix new_mat(_rows, other._cols);
+  ParallelRows(new_mat._rows, new_mat._cols, [&](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      for(size_t j = 0; j < new_mat._cols; ++j){
+        new_mat._matrix[i * new_mat._cols + j] = (T)CalculateCell(*this, other,
+                                                                  i, j, _cols);
+      }
     }
-  }
+  });
   return new_mat;
 }
 
@@ -191,7 +220,8 @@ Matrix Matrix::operator*(const Matrix& other) const{
  * @param other matrix to multiply with
  * @return reference to the updated matrix
  */
-Matrix& Matrix::operator*=(const Matrix& other){
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const BasicMatrix& other){
   *this = (*this) * other;
   return *this;
 }
@@ -202,8 +232,10 @@ Matrix& Matrix::operator*=(const Matrix& other){
  * @param scalar scalar to multiply
  * @return new Matrix with multiplied values
  */
-Matrix Matrix::operator*(const float scalar) const{
-  Matrix new_mat(*this);
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const accum_type scalar) const{
+  MATRIX_PROFILE_SCOPE(PROFILE_SCALAR, 2 * _cell_amount * sizeof(T));
+  BasicMatrix new_mat(*this);
   MultiplyByScalar(new_mat, scalar);
   return new_mat;
 }
@@ -215,7 +247,9 @@ Matrix Matrix::operator*(const float scalar) const{
  * @param matrix matrix to pultiply
  * @return new Matrix with multiplied values
  */
-Matrix operator*(const float scalar, const Matrix& matrix){
+template<typename T>
+BasicMatrix<T> operator*(const typename MatrixScalarTraits<T>::accum_type
+scalar, const BasicMatrix<T>& matrix){
   return matrix * scalar;
 }
 
@@ -224,7 +258,9 @@ Matrix operator*(const float scalar, const Matrix& matrix){
  * @param scalar scalar to multiply
  * @return reference to the matrix that have been multiplied
  */
-Matrix& Matrix::operator*=(const float scalar) noexcept{
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const accum_type scalar) noexcept{
+  MATRIX_PROFILE_SCOPE(PROFILE_SCALAR, 2 * _cell_amount * sizeof(T));
   MultiplyByScalar(*this, scalar);
   return *this;
 }
@@ -235,7 +271,8 @@ Matrix& Matrix::operator*=(const float scalar) noexcept{
  * @param scalar scalar to divide by
  * @return new matrix after division
  */
-Matrix Matrix::operator/(const float scalar) const{
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator/(const accum_type scalar) const{
   if(scalar == 0){
     throw MatrixException(ZERO_DIVISION_ERROR_MSG);
   }
@@ -247,7 +284,8 @@ Matrix Matrix::operator/(const float scalar) const{
  * @param scalar scalar to divide by
  * @return reference to the matrix that have been divided
  */
-Matrix& Matrix::operator/=(const float scalar){
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator/=(const accum_type scalar){
   if(scalar == 0){
     throw MatrixException(ZERO_DIVISION_ERROR_MSG);
   }
@@ -259,14 +297,19 @@ Matrix& Matrix::operator/=(const float scalar){
  * @param other matrix to preform addition with
  * @return new Matrix with summation values
  */
-Matrix Matrix::operator+(const Matrix& other) const{
+template<typename T>
+BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix& other) const{
   if (this->_cols != other._cols || this->_rows != other._rows){
     throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
   }
-  Matrix new_mat(_rows, _cols);
-  for(int i = 0; i < _cell_amount; ++i){
-    new_mat._matrix[i] = this->_matrix[i] + other._matrix[i];
-  }
+  MATRIX_PROFILE_SCOPE(PROFILE_MATRIX_ADD, 3 * _cell_amount * sizeof(T));
+  BasicMatrix new_mat(_rows, _cols);
+  ParallelRows(_rows, _cols, [&](size_t first, size_t last){
+    for(size_t i = first * _cols; i < last * _cols; ++i){
+      new_mat._matrix[i] = (T)((accum_type)this->_matrix[i] +
+                               (accum_type)other._matrix[i]);
+    }
+  });
   return new_mat;
 }
 
@@ -275,13 +318,18 @@ Matrix Matrix::operator+(const Matrix& other) const{
  * @param other matrix to add it's values
  * @return reference to updated matrix
  */
-Matrix& Matrix::operator+=(const Matrix& other){
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const BasicMatrix& other){
   if (this->_cols != other._cols || this->_rows != other._rows){
     throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
   }
-  for(int i = 0; i < _cell_amount; ++i){
-    this->_matrix[i] += other._matrix[i];
-  }
+  MATRIX_PROFILE_SCOPE(PROFILE_MATRIX_ADD, 3 * _cell_amount * sizeof(T));
+  ParallelRows(_rows, _cols, [&](size_t first, size_t last){
+    for(size_t i = first * _cols; i < last * _cols; ++i){
+      this->_matrix[i] = (T)((accum_type)this->_matrix[i] +
+                             (accum_type)other._matrix[i]);
+    }
+  });
   return *this;
 }
 
@@ -290,10 +338,14 @@ Matrix& Matrix::operator+=(const Matrix& other){
  * @param scalar number to add
  * @return reference to to updated matrix
  */
-Matrix& Matrix::operator+=(const float scalar) noexcept{
-  for(int i = 0; i < _cell_amount; ++i){
-    this->_matrix[i] += scalar;
-  }
+template<typename T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const accum_type scalar) noexcept{
+  MATRIX_PROFILE_SCOPE(PROFILE_SCALAR, 2 * _cell_amount * sizeof(T));
+  ParallelRows(_rows, _cols, [this, scalar](size_t first, size_t last){
+    for(size_t i = first * _cols; i < last * _cols; ++i){
+      this->_matrix[i] = (T)((accum_type)this->_matrix[i] + scalar);
+    }
+  });
   return *this;
 }
 
@@ -302,12 +354,13 @@ Matrix& Matrix::operator+=(const float scalar) noexcept{
  * @param other matrix to compare to
  * @return true in case of equality, false otherwise
  */
-bool Matrix::operator==(const Matrix& other) const noexcept{
+template<typename T>
+bool BasicMatrix<T>::operator==(const BasicMatrix& other) const noexcept{
   if(_rows != other._rows || _cols != other._cols){
     return false;
   }
-  for(int i = 0; i < _cell_amount; ++i){
-    if(_matrix[i] != other._matrix[i]){
+  for(size_t i = 0; i < _cell_amount; ++i){
+    if((accum_type)_matrix[i] != (accum_type)other._matrix[i]){
       return false;
     }
   }
@@ -319,7 +372,8 @@ bool Matrix::operator==(const Matrix& other) const noexcept{
  * @param othermatrix to compare to
  * @return true in case matrices are not equal, false otherwise
  */
-bool Matrix::operator!=(const Matrix& other) const noexcept{
+template<typename T>
+bool BasicMatrix<T>::operator!=(const BasicMatrix& other) const noexcept{
   return !(*this == other);
 }
 
@@ -329,8 +383,9 @@ bool Matrix::operator!=(const Matrix& other) const noexcept{
  * @param j column number
  * @return reference to the cell in the requested spot
  */
-float& Matrix::operator()(const int i, const int j){
-  if(i < 0 || i > (_rows - 1) || j < 0 || j > (_cols - 1)){
+template<typename T>
+T& BasicMatrix<T>::operator()(const size_t i, const size_t j){
+  if(i >= _rows || j >= _cols){
     throw MatrixException(INDEX_RANGE_ERROR_MSG);
   }
   return _matrix[i * _cols + j];
@@ -342,11 +397,12 @@ float& Matrix::operator()(const int i, const int j){
  * @param j column number
  * @return copy of the value in cell (i,j)
  */
-float Matrix::operator()(const int i, const int j) const{
-  if(i < 0 || i > (_rows - 1) || j < 0 || j > (_cols - 1)){
+template<typename T>
+T BasicMatrix<T>::operator()(const size_t i, const size_t j) const{
+  if(i >= _rows || j >= _cols){
     throw MatrixException(INDEX_RANGE_ERROR_MSG);
   }
-  float tmp = _matrix[i * _cols + j];
+  T tmp = _matrix[i * _cols + j];
   return tmp;
 }
 
@@ -356,8 +412,9 @@ float Matrix::operator()(const int i, const int j) const{
  * @param index index of the wanted cell
  * @return reference of the requested cell
  */
-float& Matrix::operator[](const int index){
-  if(index < 0 || index >= _cell_amount){
+template<typename T>
+T& BasicMatrix<T>::operator[](const size_t index){
+  if(index >= _cell_amount){
     throw MatrixException(INDEX_RANGE_ERROR_MSG);
   }
   return _matrix[index];
@@ -368,11 +425,12 @@ float& Matrix::operator[](const int index){
  * @param index index of the wanted cell
  * @return copy of the value in the requested cell
  */
-float Matrix::operator[](int index) const{
-  if(index < 0 || index >= _cell_amount){
+template<typename T>
+T BasicMatrix<T>::operator[](size_t index) const{
+  if(index >= _cell_amount){
     throw MatrixException(INDEX_RANGE_ERROR_MSG);
   }
-  float tmp = _matrix[index];
+  T tmp = _matrix[index];
   return tmp;
 }
 
@@ -383,15 +441,17 @@ float Matrix::operator[](int index) const{
  * @param matrix matrix to insert values into
  * @return reference to input stream
  */
-std::istream& operator >>(std::istream &is, Matrix& matrix){
+template<typename T>
+std::istream& operator >>(std::istream &is, BasicMatrix<T>& matrix){
   if(!is.good()){
     throw MatrixException(INPUT_STREAM_ERROR_MSG);
   }
+  MATRIX_PROFILE_SCOPE(PROFILE_IO, matrix.GetCellAmount() * sizeof(T));
 
-  int counter = 0;
-  float input_number;
+  size_t counter = 0;
+  typename BasicMatrix<T>::accum_type input_number;
   while(counter < matrix.GetCellAmount() && is >> input_number){
-    matrix[counter] = input_number;
+    matrix[counter] = (T)input_number;
     counter++;
   }
   return is;
@@ -403,13 +463,17 @@ std::istream& operator >>(std::istream &is, Matrix& matrix){
  * @param matrix matrix to send
  * @return reference to output stream
  */
-std::ostream& operator<<(std::ostream &os, const Matrix& matrix) noexcept{
+template<typename T>
+std::ostream& operator<<(std::ostream &os, const BasicMatrix<T>& matrix)
+noexcept{
+  MATRIX_PROFILE_SCOPE(PROFILE_IO, matrix.GetCellAmount() * sizeof(T));
   std::string output;
-  int printed_counter = 0;
-  int total_cells = matrix.GetCellAmount();
-  int cols = matrix.GetCols();
-  for(int i = 0; i < total_cells - 1; ++i){
-    output += std::to_string(matrix[i]);
+  size_t printed_counter = 0;
+  size_t total_cells = matrix.GetCellAmount();
+  size_t cols = matrix.GetCols();
+  for(size_t i = 0; i < total_cells - 1; ++i){
+    output += std::to_string(
+        (typename BasicMatrix<T>::accum_type)matrix[i]);
     printed_counter++;
     if(printed_counter % cols != 0){
       output += " ";
@@ -417,7 +481,8 @@ std::ostream& operator<<(std::ostream &os, const Matrix& matrix) noexcept{
       output += "\n";
     }
   }
-  output += std::to_string(matrix[(int)total_cells - 1]);
+  output += std::to_string(
+      (typename BasicMatrix<T>::accum_type)matrix[total_cells - 1]);
   return os << output;
 }
 
@@ -426,7 +491,8 @@ std::ostream& operator<<(std::ostream &os, const Matrix& matrix) noexcept{
  * space between after element(except last in row)
  * new line after every row(except last row)
  */
-void Matrix::Print() const noexcept{
+template<typename T>
+void BasicMatrix<T>::Print() const noexcept{
   std::cout << *this;
 }
 
@@ -441,11 +507,13 @@ void Matrix::Print() const noexcept{
  * columns on the right hand matrix)
  * @return calculation result according to matrices multiplication rules
  */
-float Matrix::CalculateCell(const Matrix &mat1, const Matrix &mat2, const
-int row, const int col, const int len) noexcept {
-  float sum = 0;
-  for(int i = 0; i < len; ++i){
-    sum += (mat1(row, i) * mat2(i, col));
+template<typename T>
+typename BasicMatrix<T>::accum_type BasicMatrix<T>::CalculateCell(const
+BasicMatrix &mat1, const BasicMatrix &mat2, const size_t row, const size_t
+col, const size_t len) noexcept {
+  accum_type sum = 0;
+  for(size_t i = 0; i < len; ++i){
+    sum += ((accum_type)mat1(row, i) * (accum_type)mat2(i, col));
   }
   return sum;
 }
@@ -455,13 +523,80 @@ int row, const int col, const int len) noexcept {
  * @param to_update matrix to multiply it's values
  * @param scalar scalar to multiply by
  */
-void Matrix::MultiplyByScalar(Matrix& to_update, const float scalar) noexcept{
-  for(int i = 0; i < to_update._cell_amount; ++i){
-    to_update._matrix[i] *= scalar;
-  }
+template<typename T>
+void BasicMatrix<T>::MultiplyByScalar(BasicMatrix& to_update, const
+accum_type scalar) noexcept{
+  size_t cols = to_update._cols;
+  ParallelRows(to_update._rows, cols, [&to_update, cols, scalar](size_t first,
+      size_t last){
+    for(size_t i = first * cols; i < last * cols; ++i){
+      to_update._matrix[i] = (T)((accum_type)to_update._matrix[i] * scalar);
+    }
+  });
 }
 
+/**
+ * validates dimensions and computes rows*cols without overflowing.
+ * dimensions above PTRDIFF_MAX are treated as invalid (negative values
+ * converted to size_t), products that can't be addressed as a T buffer are treated as allocation failure
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return rows*cols
+ */
+template<typename T>
+size_t BasicMatrix<T>::CheckedCellAmount(const size_t rows, const size_t
+cols){
+  if(rows == 0 || cols == 0 || rows > (size_t)PTRDIFF_MAX ||
+     cols > (size_t)PTRDIFF_MAX){
+    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+  }
+  if(rows > (SIZE_MAX / sizeof(T)) / cols){
+    throw MatrixException(ALLOC_FAIL_MSG);
+  }
+  return rows * cols;
+}
 
+/**
+ * allocating an uninitialized cells buffer (huge pages above the
+ * MatrixAllocator threshold). the pages are not touched here: the first
+ * write is done by the ParallelRows partition that later processes the same
+ * rows (NUMA first touch)
+ * @param cell_amount number of cells to allocate
+ * @return pointer to the new buffer
+ */
+template<typename T>
+T* BasicMatrix<T>::AllocateCells(const size_t cell_amount){
+  void *buffer = AllocateMatrixBuffer(cell_amount * sizeof(T));
+  MATRIX_PROFILE_ALLOCATION(cell_amount * sizeof(T));
+  if(buffer == nullptr){
+    throw MatrixException(ALLOC_FAIL_MSG);
+  }
+  return static_cast<T*>(buffer);
+}
 
+/**
+ * freeing a buffer returned from AllocateCells
+ * @param cells buffer to free
+ */
+template<typename T>
+void BasicMatrix<T>::FreeCells(T* cells) noexcept{
+  MATRIX_TRACE_FREE(cells);
+  FreeMatrixBuffer(cells);
+}
 
-
+template class BasicMatrix<float>;
+template class BasicMatrix<double>;
+template class BasicMatrix<Half>;
+
+template Matrix operator*(float scalar, const Matrix& matrix);
+template DoubleMatrix operator*(double scalar, const DoubleMatrix& matrix);
+template HalfMatrix operator*(float scalar, const HalfMatrix& matrix);
+template std::istream& operator>>(std::istream &is, Matrix& matrix);
+template std::istream& operator>>(std::istream &is, DoubleMatrix& matrix);
+template std::istream& operator>>(std::istream &is, HalfMatrix& matrix);
+template std::ostream& operator<<(std::ostream &os, const Matrix& matrix)
+noexcept;
+template std::ostream& operator<<(std::ostream &os, const DoubleMatrix&
+matrix) noexcept;
+template std::ostream& operator<<(std::ostream &os, const HalfMatrix& matrix)
+noexcept;
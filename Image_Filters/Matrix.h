@@ -9,6 +9,7 @@
  */
 
 #include <cmath>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -16,20 +17,73 @@
 #ifndef EX5__MATRIX_H_
 #define EX5__MATRIX_H_
 #include "MatrixException.h"
+#include "Half.h"
 
+/**
+ * MatrixScalarTraits type used for arithmetic on a matrix's scalar type:
+ * float and double accumulate in themselves, Half accumulates in float
+ */
+template<typename T>
+struct MatrixScalarTraits
+{
+  typedef T accum_type;
+};
+
+template<>
+struct MatrixScalarTraits<Half>
+{
+  typedef float accum_type;
+};
+
+template<typename T>
+class BasicMatrix;
+
+/**
+ * multiply all matrix cells in scalar, multiplication on the left and
+ * create new matrix with the result values
+ * @param scalar scalar to multiply
+ * @param matrix matrix to pultiply
+ * @return new Matrix with multiplied values
+ */
+template<typename T>
+BasicMatrix<T> operator*(typename MatrixScalarTraits<T>::accum_type scalar,
+                         const BasicMatrix<T>& matrix);
+
+template<typename T>
+std::istream& operator>>(std::istream &is, BasicMatrix<T>& matrix);
+
+template<typename T>
+std::ostream& operator<<(std::ostream &os, const BasicMatrix<T>& matrix)
+noexcept;
 
-class Matrix
+/**
+ * matrix of T cells (float, double or Half). cells are stored as T,
+ * arithmetic is done in MatrixScalarTraits<T>::accum_type
+ */
+template<typename T>
+class BasicMatrix
 {
-  int _rows;
-  int _cols;
-  int _cell_amount;
-  float *_matrix;
+ public:
+  /**
+   * type of a single cell
+   */
+  typedef T value_type;
+  /**
+   * type arithmetic (and scalar operands) are computed in
+   */
+  typedef typename MatrixScalarTraits<T>::accum_type accum_type;
+
+ private:
+  size_t _rows;
+  size_t _cols;
+  size_t _cell_amount;
+  T *_matrix;
 
   /**
    * PRIVATE FUNCTION: getter for _cell_amount
    * @return _cell_amount
    */
-  int GetCellAmount() const noexcept{
+  size_t GetCellAmount() const noexcept{
     return _cell_amount;
   }
 
@@ -44,8 +98,34 @@ class Matrix
    * columns on the right hand matrix)
    * @return calculation result according to matrices multiplication rules
    */
-  static float CalculateCell(const Matrix &mat1, const Matrix &mat2, int
-  row, int col, int len) noexcept;
+  static accum_type CalculateCell(const BasicMatrix &mat1, const BasicMatrix
+  &mat2, size_t row, size_t col, size_t len) noexcept;
+
+  /**
+   * validates dimensions and computes rows*cols without overflowing.
+   * dimensions above PTRDIFF_MAX are treated as invalid (negative values
+   * converted to size_t), products that can't be addressed as a T buffer are treated as allocation failure
+   * @param rows number of rows
+   * @param cols number of columns
+   * @return rows*cols
+   */
+  static size_t CheckedCellAmount(size_t rows, size_t cols);
+
+  /**
+   * allocating an uninitialized cells buffer (huge pages above the
+   * MatrixAllocator threshold). the pages are not touched here: the first
+   * write is done by the ParallelRows partition that later processes the
+   * same rows (NUMA first touch)
+   * @param cell_amount number of cells to allocate
+   * @return pointer to the new buffer
+   */
+  static T* AllocateCells(size_t cell_amount);
+
+  /**
+   * freeing a buffer returned from AllocateCells
+   * @param cells buffer to free
+   */
+  static void FreeCells(T* cells) noexcept;
 
 
   /**
@@ -53,7 +133,8 @@ class Matrix
    * @param to_update matrix to multiply it's values
    * @param scalar scalar to multiply by
    */
-  static void MultiplyByScalar(Matrix& to_update, float scalar) noexcept;
+  static void MultiplyByScalar(BasicMatrix& to_update, accum_type scalar)
+  noexcept;
 
 
  public:
@@ -63,35 +144,47 @@ class Matrix
    * @param rows number of rows for the Matrix
    * @param cols number of columns for the Matrix
    */
-  Matrix(int rows, int cols);
+  BasicMatrix(size_t rows, size_t cols);
 
   /**
    * default constructor initiating new Matrix in size of 1*1
    */
-  Matrix();
+  BasicMatrix();
 
   /**
    * copy constructor creating new Matrix using other given Matrix
    * @param m given Matrix to create from
    */
-  Matrix(const Matrix &m);
+  BasicMatrix(const BasicMatrix &m);
 
   /**
    * destructor for Matrix object
    */
-  ~Matrix();
+  ~BasicMatrix();
 
   /**
    * getter for matrix._rows
    * @return number of rows in matrix
    */
-  int GetRows() const noexcept;
+  size_t GetRows() const noexcept;
 
   /**
    * getter for matrix._cols
    * @return number of columns in matrix
    */
-  int GetCols() const noexcept;
+  size_t GetCols() const noexcept;
+
+  /**
+   * getter for the raw cells buffer (row-major, _rows*_cols cells)
+   * @return pointer to the first cell of the matrix
+   */
+  T* GetMatrix() noexcept;
+
+  /**
+   * getter for the raw cells buffer of a const matrix
+   * @return const pointer to the first cell of the matrix
+   */
+  const T* GetMatrix() const noexcept;
 
   /**
    * prints the matrix according to format:
@@ -105,7 +198,7 @@ class Matrix
    * IMPORTANT: when activated this action is irreversible due to chane in
    * dimensions
    */
-  Matrix& Vectorize() noexcept; //no need for const version
+  BasicMatrix& Vectorize() noexcept; //no need for const version
 
   /**
    *
@@ -113,7 +206,7 @@ class Matrix
    * called this operator at
    * @return reference to the Matrix we called the operator at after updating
    */
-  Matrix& operator=(const Matrix& other);//no need for const version
+  BasicMatrix& operator=(const BasicMatrix& other);//no need for const version
 
 
   /**
@@ -122,7 +215,7 @@ class Matrix
    * dimensions are valid
    * @return new Matrix object whis is the result of the Matrices multiplication
    */
-  Matrix operator*(const Matrix& other) const;
+  BasicMatrix operator*(const BasicMatrix& other) const;
 
   /**
    * multiplies matrix we called the operator at with other matrix accordint
@@ -130,7 +223,7 @@ class Matrix
    * @param other matrix to multiply with
    * @return reference to the updated matrix
    */
-  Matrix& operator*=(const Matrix& other);
+  BasicMatrix& operator*=(const BasicMatrix& other);
 
   /**
    * multiply all matrix cells in scalar, multiplication on the right and
@@ -138,23 +231,14 @@ class Matrix
    * @param scalar scalar to multiply
    * @return new Matrix with multiplied values
    */
-  Matrix operator*(float scalar) const;
-
-  /**
-   * multiply all matrix cells in scalar, multiplication on the left and
-   * create new matrix with the result values
-   * @param scalar scalar to multiply
-   * @param matrix matrix to pultiply
-   * @return new Matrix with multiplied values
-   */
-  friend Matrix operator*(float scalar, const Matrix& matrix);
+  BasicMatrix operator*(accum_type scalar) const;
 
   /**
    * multiplies Matrix by scalar and updates the given matrix itself
    * @param scalar scalar to multiply
    * @return reference to the matrix that have been multiplied
    */
-  Matrix& operator*=(float scalar) noexcept;//no need for const version
+  BasicMatrix& operator*=(accum_type scalar) noexcept;//no need for const version
 
   /**
    * creates new copy of the matrix we called the operator at and divides all
@@ -162,49 +246,49 @@ class Matrix
    * @param scalar scalar to divide by
    * @return new matrix after division
    */
-  Matrix operator/(float scalar) const;
+  BasicMatrix operator/(accum_type scalar) const;
 
   /**
    * divides Matrix by scalar and updates the given matrix
    * @param scalar scalar to divide by
    * @return reference to the matrix that have been divided
    */
-  Matrix& operator/=(float scalar);//no need for const version
+  BasicMatrix& operator/=(accum_type scalar);//no need for const version
 
   /**
    * summing to matrices and insert values to new Matrix
    * @param other matrix to preform addition with
    * @return new Matrix with summation values
    */
-  Matrix operator+(const Matrix& other) const;
+  BasicMatrix operator+(const BasicMatrix& other) const;
 
   /**
    * adding given matrix values to the matrix we called the operator on
    * @param other matrix to add it's values
    * @return reference to updated matrix
    */
-  Matrix& operator+=(const Matrix& other);//no need for const version
+  BasicMatrix& operator+=(const BasicMatrix& other);//no need for const version
 
   /**
    * adds the value scalar for every value in the matrix
    * @param scalar number to add
    * @return reference to to updated matrix
    */
-  Matrix& operator+=(float scalar) noexcept;//no need for const version
+  BasicMatrix& operator+=(accum_type scalar) noexcept;//no need for const version
 
   /**
    * checks if two given matrices are equal
    * @param other matrix to compare to
    * @return true in case of equality, false otherwise
    */
-  bool operator==(const Matrix& other) const noexcept;
+  bool operator==(const BasicMatrix& other) const noexcept;
 
   /**
    * checks if two given marices are not equal
    * @param othermatrix to compare to
    * @return true in case matrices are not equal, false otherwise
    */
-  bool operator!=(const Matrix& other) const noexcept;
+  bool operator!=(const BasicMatrix& other) const noexcept;
 
   /**
    * returns reference to the value in cell in place (i,j) of given matrix
@@ -212,7 +296,7 @@ class Matrix
    * @param j column number
    * @return reference to the cell in the requested spot
    */
-  float& operator()(int i, int j);
+  T& operator()(size_t i, size_t j);
 
   /**
    * returns the value of the matrix in place (i,j)
@@ -220,7 +304,7 @@ class Matrix
    * @param j column number
    * @return copy of the value in cell (i,j)
    */
-  float operator()(int i, int j) const;
+  T operator()(size_t i, size_t j) const;
 
   /**
    * returns reference to a cell in the matrix by single index: index =
@@ -228,14 +312,14 @@ class Matrix
    * @param index index of the wanted cell
    * @return reference of the requested cell
    */
-  float& operator[](int index);
+  T& operator[](size_t index);
 
   /**
    * return the value of matrix's cell by single index: index = i*_rows+j
    * @param index index of the wanted cell
    * @return copy of the value in the requested cell
    */
-  float operator[](int index)const;
+  T operator[](size_t index)const;
 
   /**
    * input stream operator taking float values and puts them into matrix in
@@ -244,7 +328,7 @@ class Matrix
    * @param matrix matrix to insert values into
    * @return reference to input stream
    */
-  friend std::istream& operator>>(std::istream &is, Matrix& matrix);
+  friend std::istream& operator>><>(std::istream &is, BasicMatrix& matrix);
 
   /**
    * output stream operator that send the matrix values by specific format
@@ -252,9 +336,30 @@ class Matrix
    * @param matrix matrix to send
    * @return reference to output stream
    */
-  friend std::ostream& operator<<(std::ostream &os, const Matrix& matrix) noexcept;
+  friend std::ostream& operator<<<>(std::ostream &os, const BasicMatrix&
+      matrix) noexcept;
 };
 
+/**
+ * single precision matrix- the type used by the filters
+ */
+typedef BasicMatrix<float> Matrix;
+
+/**
+ * double precision matrix for long accumulations
+ */
+typedef BasicMatrix<double> DoubleMatrix;
+
+/**
+ * 16 bit storage matrix (float accumulation) for bandwidth bound workloads
+ */
+typedef BasicMatrix<Half> HalfMatrix;
+
+//implemented and instantiated in Matrix.cc for these scalar types only
+extern template class BasicMatrix<float>;
+extern template class BasicMatrix<double>;
+extern template class BasicMatrix<Half>;
+
 
 
 #endif //EX5__MATRIX_H_
@@ -0,0 +1,247 @@
+/**
+ * @file MatrixAllocator.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for MatrixAllocator.h file
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "MatrixAllocator.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/**
+ * HEAP_ALIGNMENT alignment of heap buffers (cache line)
+ */
+#define HEAP_ALIGNMENT 64
+
+/**
+ * HUGE_PAGE_SIZE size of a (2MB) huge page
+ */
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+/**
+ * MappedBuffer bookkeeping of a buffer that was mapped (not heap). kept out
+ * of the buffer, so its first page is untouched until the caller's first
+ * touch and the cells start on a huge page boundary
+ */
+struct MappedBuffer
+{
+  size_t mapped_bytes;
+  BufferKind kind;
+};
+
+static std::atomic<HugePageMode> huge_page_mode(HUGE_PAGES_TRANSPARENT);
+static std::atomic<size_t> huge_page_threshold(HUGE_PAGE_DEFAULT_THRESHOLD);
+static std::atomic<size_t> heap_counter(0);
+static std::atomic<size_t> advised_counter(0);
+static std::atomic<size_t> explicit_counter(0);
+static std::atomic<size_t> fallback_counter(0);
+
+//every mapped buffer by its address, guarded by mapped_mutex. buffers not in
+//the table are heap buffers
+static std::mutex mapped_mutex;
+static std::unordered_map<const void*, MappedBuffer> mapped_buffers;
+//amount of buffers in mapped_buffers, read without the mutex
+static std::atomic<size_t> mapped_count(0);
+
+/**
+ * rounds size up to a multiple of HUGE_PAGE_SIZE
+ * @param size size to round
+ * @return rounded size
+ */
+static size_t RoundToHugePage(size_t size) noexcept{
+  return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+#ifdef __linux__
+/**
+ * records a new mapping in the side table, unmapping it if the table can't
+ * grow
+ * @param base start of the mapping
+ * @param mapped_bytes size of the mapping
+ * @param kind the way it was mapped
+ * @return base, nullptr if it couldn't be recorded
+ */
+static void* RecordMapping(void* base, size_t mapped_bytes, BufferKind kind)
+noexcept{
+  try{
+    std::lock_guard<std::mutex> lock(mapped_mutex);
+    mapped_buffers[base] = MappedBuffer{mapped_bytes, kind};
+    mapped_count++;
+  }catch(...){
+    munmap(base, mapped_bytes);
+    return nullptr;
+  }
+  return base;
+}
+
+/**
+ * maps memory from the hugetlbfs pool
+ * @param bytes size of the buffer
+ * @return buffer, nullptr if the pool can't supply it
+ */
+static void* MapExplicitHuge(size_t bytes) noexcept{
+  size_t mapped = RoundToHugePage(bytes);
+  void *base = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if(base == MAP_FAILED){
+    return nullptr;
+  }
+  return RecordMapping(base, mapped, BUFFER_EXPLICIT_HUGE);
+}
+
+/**
+ * maps 2MB aligned memory and advises the kernel to back it with
+ * transparent huge pages
+ * @param bytes size of the buffer
+ * @return buffer, nullptr if the mapping failed
+ */
+static void* MapTransparentHuge(size_t bytes) noexcept{
+  size_t mapped = RoundToHugePage(bytes);
+  //over-map by one huge page so an aligned start can be cut out of it
+  void *raw = mmap(nullptr, mapped + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(raw == MAP_FAILED){
+    return nullptr;
+  }
+  auto raw_start = reinterpret_cast<uintptr_t>(raw);
+  uintptr_t start = (raw_start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+  size_t head = start - raw_start;
+  if(head != 0){
+    munmap(raw, head);
+  }
+  size_t tail = HUGE_PAGE_SIZE - head;
+  if(tail != 0){
+    munmap(reinterpret_cast<void*>(start + mapped), tail);
+  }
+  void *base = reinterpret_cast<void*>(start);
+  if(madvise(base, mapped, MADV_HUGEPAGE) != 0){
+    munmap(base, mapped);
+    return nullptr;
+  }
+  return RecordMapping(base, mapped, BUFFER_TRANSPARENT_HUGE);
+}
+#endif
+
+/**
+ * tells the heap buffers apart without the mutex: no buffer is mapped, or
+ * buffer doesn't start on a huge page boundary (every mapping does)
+ * @param buffer buffer returned from AllocateMatrixBuffer
+ * @return false if buffer is a heap buffer, true if it may be mapped
+ */
+static bool MayBeMapped(const void* buffer) noexcept{
+  return mapped_count.load(std::memory_order_acquire) != 0 &&
+         (reinterpret_cast<uintptr_t>(buffer) & (HUGE_PAGE_SIZE - 1)) == 0;
+}
+
+/**
+ * sets the allocation policy
+ * @param mode huge page mode for buffers above the threshold
+ * @param threshold_bytes minimal buffer size to use huge pages for
+ */
+void SetHugePagePolicy(HugePageMode mode, size_t threshold_bytes) noexcept{
+  huge_page_mode = mode;
+  huge_page_threshold = threshold_bytes;
+}
+
+/**
+ * @return the current huge page mode
+ */
+HugePageMode GetHugePageMode() noexcept{
+  return huge_page_mode;
+}
+
+/**
+ * @return counters of all allocations done so far
+ */
+HugePageCounters GetHugePageCounters() noexcept{
+  return HugePageCounters{heap_counter, advised_counter, explicit_counter,
+                          fallback_counter};
+}
+
+/**
+ * allocating an uninitialized buffer according to the current policy
+ * @param bytes size of the buffer
+ * @return pointer to the buffer, nullptr in case of allocation failure
+ */
+void* AllocateMatrixBuffer(size_t bytes) noexcept{
+  if(bytes > SIZE_MAX - 2 * HUGE_PAGE_SIZE){
+    return nullptr;
+  }
+#ifdef __linux__
+  HugePageMode mode = huge_page_mode;
+  if(mode != HUGE_PAGES_OFF && bytes >= huge_page_threshold){
+    void *buffer = nullptr;
+    if(mode == HUGE_PAGES_EXPLICIT){
+      buffer = MapExplicitHuge(bytes);
+      if(buffer != nullptr){
+        explicit_counter++;
+        return buffer;
+      }
+      fallback_counter++;
+    }
+    buffer = MapTransparentHuge(bytes);
+    if(buffer != nullptr){
+      advised_counter++;
+      return buffer;
+    }
+    fallback_counter++;
+  }
+#endif
+  void *buffer = ::operator new(bytes, std::align_val_t(HEAP_ALIGNMENT),
+                                std::nothrow);
+  if(buffer != nullptr){
+    heap_counter++;
+  }
+  return buffer;
+}
+
+/**
+ * freeing a buffer returned from AllocateMatrixBuffer (nullptr is ignored)
+ * @param buffer buffer to free
+ */
+void FreeMatrixBuffer(void* buffer) noexcept{
+  if(buffer == nullptr){
+    return;
+  }
+#ifdef __linux__
+  size_t mapped_bytes = 0;
+  if(MayBeMapped(buffer)){
+    std::lock_guard<std::mutex> lock(mapped_mutex);
+    auto mapping = mapped_buffers.find(buffer);
+    if(mapping != mapped_buffers.end()){
+      mapped_bytes = mapping->second.mapped_bytes;
+      mapped_buffers.erase(mapping);
+      mapped_count--;
+    }
+  }
+  if(mapped_bytes != 0){
+    munmap(buffer, mapped_bytes);
+    return;
+  }
+#endif
+  ::operator delete(buffer, std::align_val_t(HEAP_ALIGNMENT));
+}
+
+/**
+ * @param buffer buffer returned from AllocateMatrixBuffer
+ * @return the way the buffer was allocated
+ */
+BufferKind GetBufferKind(const void* buffer) noexcept{
+  if(!MayBeMapped(buffer)){
+    return BUFFER_HEAP;
+  }
+  std::lock_guard<std::mutex> lock(mapped_mutex);
+  auto mapping = mapped_buffers.find(buffer);
+  return mapping == mapped_buffers.end() ? BUFFER_HEAP : mapping->second.kind;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file MatrixAllocator.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for matrix buffer allocation (huge page policy)
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstddef>
+
+#ifndef EX5__MATRIX_ALLOCATOR_H_
+#define EX5__MATRIX_ALLOCATOR_H_
+
+/**
+ * HUGE_PAGE_DEFAULT_THRESHOLD buffers of at least this many bytes are
+ * backed by huge pages (unless the policy is HUGE_PAGES_OFF)
+ */
+#define HUGE_PAGE_DEFAULT_THRESHOLD (8u << 20)
+
+/**
+ * HugePageMode policy for buffers above the threshold:
+ * HUGE_PAGES_OFF- regular heap allocation
+ * HUGE_PAGES_TRANSPARENT- 2MB aligned mapping advised for transparent huge
+ * pages (madvise MADV_HUGEPAGE)
+ * HUGE_PAGES_EXPLICIT- mapping from the reserved hugetlbfs pool
+ * (MAP_HUGETLB), falling back to transparent and then to the heap
+ */
+enum HugePageMode {HUGE_PAGES_OFF, HUGE_PAGES_TRANSPARENT, HUGE_PAGES_EXPLICIT};
+
+/**
+ * BufferKind the way a specific buffer was allocated:
+ * BUFFER_HEAP- heap memory, 64 byte aligned
+ * BUFFER_TRANSPARENT_HUGE- 2MB aligned mapping advised for transparent huge
+ * pages. whether the kernel actually backs it with huge pages is only known
+ * at page fault time (see AnonHugePages in /proc/self/smaps)
+ * BUFFER_EXPLICIT_HUGE- mapping from the hugetlbfs pool
+ */
+enum BufferKind {BUFFER_HEAP, BUFFER_TRANSPARENT_HUGE, BUFFER_EXPLICIT_HUGE};
+
+/**
+ * HugePageCounters amount of buffers allocated by every kind, and amount of
+ * times the requested huge page mode wasn't available and a fallback was used.
+ * transparent_advised counts mappings advised for transparent huge pages,
+ * not mappings the kernel actually backed with them
+ */
+struct HugePageCounters
+{
+  size_t heap;
+  size_t transparent_advised;
+  size_t explicit_huge;
+  size_t fallbacks;
+};
+
+/**
+ * sets the allocation policy (default: HUGE_PAGES_TRANSPARENT above
+ * HUGE_PAGE_DEFAULT_THRESHOLD). on non linux systems every buffer is
+ * allocated from the heap
+ * @param mode huge page mode for buffers above the threshold
+ * @param threshold_bytes minimal buffer size to use huge pages for
+ */
+void SetHugePagePolicy(HugePageMode mode,
+                       size_t threshold_bytes = HUGE_PAGE_DEFAULT_THRESHOLD)
+                       noexcept;
+
+/**
+ * @return the current huge page mode
+ */
+HugePageMode GetHugePageMode() noexcept;
+
+/**
+ * @return counters of all allocations done so far
+ */
+HugePageCounters GetHugePageCounters() noexcept;
+
+/**
+ * allocating an uninitialized buffer according to the current policy: heap
+ * buffers are 64 byte aligned, mapped buffers start on a huge page boundary.
+ * the bookkeeping of mapped buffers is kept in a side table, so none of
+ * their pages is touched before the caller's first touch
+ * @param bytes size of the buffer
+ * @return pointer to the buffer, nullptr in case of allocation failure
+ */
+void* AllocateMatrixBuffer(size_t bytes) noexcept;
+
+/**
+ * freeing a buffer returned from AllocateMatrixBuffer (nullptr is ignored)
+ * @param buffer buffer to free
+ */
+void FreeMatrixBuffer(void* buffer) noexcept;
+
+/**
+ * @param buffer buffer returned from AllocateMatrixBuffer
+ * @return the way the buffer was allocated
+ */
+BufferKind GetBufferKind(const void* buffer) noexcept;
+
+
+#endif //EX5__MATRIX_ALLOCATOR_H_
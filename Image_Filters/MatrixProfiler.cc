@@ -0,0 +1,136 @@
+/**
+ * @file MatrixProfiler.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for MatrixProfiler.h file
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "MatrixProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+
+/**
+ * OpCounters the shared counters of one operation (relaxed atomics: they
+ * are updated from any thread)
+ */
+struct OpCounters
+{
+  std::atomic<size_t> calls;
+  std::atomic<size_t> total_ns;
+  std::atomic<size_t> bytes_allocated;
+  std::atomic<size_t> bytes_moved;
+};
+
+static OpCounters op_counters[PROFILE_OP_COUNT];
+
+/**
+ * innermost running operation of the thread
+ */
+static thread_local ProfiledOp current_op = PROFILE_OTHER;
+
+static const char* const op_names[PROFILE_OP_COUNT] = {
+    "operator*", "operator+", "scalar", "copy", "MatrixConvolution", "Blur",
+    "Sobel", "Quantization", "I/O", "other"};
+
+/**
+ * @return steady clock time in nanoseconds
+ */
+static long long NowNs() noexcept{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @param op operation
+ * @return its counters
+ */
+OpProfile GetOpProfile(ProfiledOp op) noexcept{
+  const OpCounters &counters = op_counters[op];
+  return OpProfile{counters.calls.load(std::memory_order_relaxed),
+                   counters.total_ns.load(std::memory_order_relaxed),
+                   counters.bytes_allocated.load(std::memory_order_relaxed),
+                   counters.bytes_moved.load(std::memory_order_relaxed)};
+}
+
+/**
+ * @param op operation
+ * @return its name
+ */
+const char* GetOpName(ProfiledOp op) noexcept{
+  return op_names[op];
+}
+
+/**
+ * sets all counters to zero
+ */
+void ResetOpProfiles() noexcept{
+  for(OpCounters &counters : op_counters){
+    counters.calls = 0;
+    counters.total_ns = 0;
+    counters.bytes_allocated = 0;
+    counters.bytes_moved = 0;
+  }
+}
+
+/**
+ * writes one line per operation that was called or allocated
+ * @param os stream to write to
+ */
+void DumpOpProfiles(std::ostream& os){
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::left << std::setw(18) << "op" << std::right << std::setw(10)
+     << "calls" << std::setw(14) << "total ms" << std::setw(14) << "mean us"
+     << std::setw(16) << "bytes alloc" << std::setw(16) << "bytes moved"
+     << "\n";
+  for(int i = 0; i < PROFILE_OP_COUNT; ++i){
+    OpProfile profile = GetOpProfile((ProfiledOp)i);
+    if(profile.calls == 0 && profile.bytes_allocated == 0){
+      continue;
+    }
+    double mean_us = profile.calls == 0 ? 0 :
+                     profile.total_ns / 1e3 / profile.calls;
+    os << std::left << std::setw(18) << op_names[i] << std::right
+       << std::setw(10) << profile.calls << std::setw(14) << std::fixed
+       << std::setprecision(3) << profile.total_ns / 1e6 << std::setw(14)
+       << mean_us << std::setw(16) << profile.bytes_allocated
+       << std::setw(16) << profile.bytes_moved << "\n";
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+/**
+ * charges an allocation to the innermost running operation of this thread
+ * @param bytes size of the allocation
+ */
+void RecordProfiledAllocation(size_t bytes) noexcept{
+  op_counters[current_op].bytes_allocated.fetch_add(
+      bytes, std::memory_order_relaxed);
+}
+
+/**
+ * starts timing a call
+ * @param op operation called
+ * @param bytes_moved bytes of cells the call reads and writes
+ */
+ProfileScope::ProfileScope(ProfiledOp op, size_t bytes_moved) noexcept
+    : _op(op), _outer_op(current_op), _start_ns(NowNs()){
+  current_op = op;
+  op_counters[op].calls.fetch_add(1, std::memory_order_relaxed);
+  op_counters[op].bytes_moved.fetch_add(bytes_moved,
+                                        std::memory_order_relaxed);
+}
+
+/**
+ * adds the time of the call
+ */
+ProfileScope::~ProfileScope(){
+  op_counters[_op].total_ns.fetch_add(NowNs() - _start_ns,
+                                      std::memory_order_relaxed);
+  current_op = _outer_op;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file MatrixProfiler.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for the opt-in per operation profiling counters of Matrix
+ * and the filters (build with -DMATRIX_PROFILING)
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstddef>
+#include <ostream>
+
+#ifndef EX5__MATRIX_PROFILER_H_
+#define EX5__MATRIX_PROFILER_H_
+
+/**
+ * ProfiledOp operations with their own counters:
+ * PROFILE_MATRIX_MUL- operator* of two matrices (operator*= counts as
+ * operator* and a copy)
+ * PROFILE_MATRIX_ADD- operator+ / operator+= of two matrices
+ * PROFILE_SCALAR- scalar operator*, operator*= and operator+= (operator/ and
+ * operator/= count as the multiplication they call)
+ * PROFILE_COPY- copy constructor and operator=
+ * PROFILE_CONVOLUTION- MatrixConvolution
+ * PROFILE_BLUR, PROFILE_SOBEL, PROFILE_QUANTIZATION- the filters
+ * PROFILE_IO- operator>> and operator<<
+ * PROFILE_OTHER- allocations made outside all of the above (e.g. a Matrix
+ * constructed by the caller)
+ */
+enum ProfiledOp {PROFILE_MATRIX_MUL, PROFILE_MATRIX_ADD, PROFILE_SCALAR,
+    PROFILE_COPY, PROFILE_CONVOLUTION, PROFILE_BLUR, PROFILE_SOBEL,
+    PROFILE_QUANTIZATION, PROFILE_IO, PROFILE_OTHER, PROFILE_OP_COUNT};
+
+/**
+ * OpProfile counters of one operation. time is inclusive (Sobel's time
+ * contains its convolutions), allocations are charged to the innermost
+ * running operation only
+ * calls- amount of calls
+ * total_ns- time spent in the calls
+ * bytes_allocated- bytes of matrix buffers allocated during the calls
+ * bytes_moved- bytes of cells read and written by the calls
+ */
+struct OpProfile
+{
+  size_t calls;
+  size_t total_ns;
+  size_t bytes_allocated;
+  size_t bytes_moved;
+};
+
+/**
+ * @param op operation
+ * @return its counters
+ */
+OpProfile GetOpProfile(ProfiledOp op) noexcept;
+
+/**
+ * @param op operation
+ * @return its name
+ */
+const char* GetOpName(ProfiledOp op) noexcept;
+
+/**
+ * sets all counters to zero
+ */
+void ResetOpProfiles() noexcept;
+
+/**
+ * writes one line per operation that was called or allocated: name, calls,
+ * total and mean time, bytes allocated and moved
+ * @param os stream to write to
+ */
+void DumpOpProfiles(std::ostream& os);
+
+/**
+ * charges an allocation to the innermost running operation of this thread
+ * (PROFILE_OTHER if none)
+ * @param bytes size of the allocation
+ */
+void RecordProfiledAllocation(size_t bytes) noexcept;
+
+/**
+ * ProfileScope counts a call of an operation and its time until the scope
+ * ends. scopes nest per thread
+ */
+class ProfileScope
+{
+ public:
+  /**
+   * starts timing a call
+   * @param op operation called
+   * @param bytes_moved bytes of cells the call reads and writes
+   */
+  ProfileScope(ProfiledOp op, size_t bytes_moved) noexcept;
+
+  /**
+   * adds the time of the call
+   */
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  ProfiledOp _op;
+  ProfiledOp _outer_op;
+  long long _start_ns;
+};
+
+/**
+ * MATRIX_PROFILE_SCOPE(op, bytes_moved) profiles the rest of the enclosing
+ * block as one call of op
+ * MATRIX_PROFILE_ALLOCATION(bytes) charges a matrix buffer allocation to the
+ * running operation
+ * both compile to nothing when MATRIX_PROFILING isn't defined
+ */
+#ifdef MATRIX_PROFILING
+#define MATRIX_PROFILE_SCOPE(op, bytes_moved) \
+  ProfileScope profile_scope(op, bytes_moved)
+#define MATRIX_PROFILE_ALLOCATION(bytes) RecordProfiledAllocation(bytes)
+#else
+#define MATRIX_PROFILE_SCOPE(op, bytes_moved) ((void)0)
+#define MATRIX_PROFILE_ALLOCATION(bytes) ((void)0)
+#endif
+
+
+#endif //EX5__MATRIX_PROFILER_H_
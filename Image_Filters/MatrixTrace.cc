@@ -0,0 +1,210 @@
+/**
+ * @file MatrixTrace.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for MatrixTrace.h file
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "MatrixTrace.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * PendingCopy last copy of a thread, until its next allocation
+ */
+struct PendingCopy
+{
+  const void *source;
+  const char *tag;
+  size_t bytes;
+};
+
+//everything below is guarded by trace_mutex
+static std::mutex trace_mutex;
+//size of every live buffer
+static std::unordered_map<const void*, size_t> live_buffers;
+static std::map<std::string, MatrixTraceTagStats> tag_stats;
+static MatrixTraceTotals totals{0, 0, 0, 0, 0, 0};
+
+/**
+ * innermost tag of the thread (nullptr: untagged)
+ */
+static thread_local const char *current_tag = nullptr;
+
+/**
+ * the thread's last copy, source == nullptr if an allocation came after it
+ */
+static thread_local PendingCopy pending_copy{nullptr, nullptr, 0};
+
+/**
+ * @return current tag of the thread
+ */
+static const char* CurrentTag() noexcept{
+  return current_tag != nullptr ? current_tag : TRACE_UNTAGGED_NAME;
+}
+
+/**
+ * records an allocation of a Matrix buffer
+ * @param buffer the new buffer
+ * @param bytes its size
+ * @param kind function that allocated it
+ * @param source buffer copied from, nullptr if none
+ */
+void TraceMatrixAllocation(const void* buffer, size_t bytes, TraceKind kind,
+                           const void* source) noexcept{
+  const char *tag = CurrentTag();
+  bool is_copy = kind != TRACE_CONSTRUCT;
+  pending_copy = is_copy ? PendingCopy{source, tag, bytes} :
+                 PendingCopy{nullptr, nullptr, 0};
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  try{
+    live_buffers[buffer] = bytes;
+    MatrixTraceTagStats &stats = tag_stats[tag];
+    stats.allocations++;
+    stats.bytes += bytes;
+    if(is_copy){
+      stats.copies++;
+      stats.copy_bytes += bytes;
+    }
+  }catch(...){
+    //out of memory for the bookkeeping: the buffer stays untraced
+    return;
+  }
+  totals.allocations++;
+  totals.copies += is_copy ? 1 : 0;
+  totals.live_buffers++;
+  totals.live_bytes += bytes;
+  totals.peak_bytes = std::max(totals.peak_bytes, totals.live_bytes);
+}
+
+/**
+ * records the freeing of a traced buffer
+ * @param buffer buffer freed
+ */
+void TraceMatrixFree(const void* buffer) noexcept{
+  bool discarded = pending_copy.source != nullptr &&
+                   pending_copy.source == buffer;
+  PendingCopy copy = pending_copy;
+  if(discarded){
+    pending_copy.source = nullptr;
+  }
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  auto record = live_buffers.find(buffer);
+  if(record == live_buffers.end()){
+    return;
+  }
+  totals.live_buffers--;
+  totals.live_bytes -= record->second;
+  live_buffers.erase(record);
+  if(discarded){
+    totals.copy_then_discard++;
+    try{
+      auto stats = tag_stats.find(copy.tag);
+      if(stats != tag_stats.end()){
+        stats->second.discards++;
+        stats->second.discard_bytes += copy.bytes;
+      }
+    }catch(...){
+      //the tag's key couldn't be built: counted in the totals only
+    }
+  }
+}
+
+/**
+ * @return totals of all traced buffers
+ */
+MatrixTraceTotals GetMatrixTraceTotals() noexcept{
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  return totals;
+}
+
+/**
+ * @param tag name of a tag
+ * @return the tag's stats, all zero if nothing was allocated under it
+ */
+MatrixTraceTagStats GetMatrixTraceTagStats(const char* tag) noexcept{
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  try{
+    auto stats = tag_stats.find(tag);
+    if(stats != tag_stats.end()){
+      return stats->second;
+    }
+  }catch(...){
+    //the tag's key couldn't be built: nothing can be stored under it either
+  }
+  return MatrixTraceTagStats{0, 0, 0, 0, 0, 0};
+}
+
+/**
+ * writes the totals and one line per tag
+ * @param os stream to write to
+ */
+void DumpMatrixTrace(std::ostream& os){
+  std::ios::fmtflags flags = os.flags();
+  std::vector<std::pair<std::string, MatrixTraceTagStats>> sorted;
+  MatrixTraceTotals snapshot;
+  {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    sorted.assign(tag_stats.begin(), tag_stats.end());
+    snapshot = totals;
+  }
+  std::sort(sorted.begin(), sorted.end(), [](
+      const std::pair<std::string, MatrixTraceTagStats>& lhs,
+      const std::pair<std::string, MatrixTraceTagStats>& rhs){
+    return lhs.second.bytes > rhs.second.bytes;
+  });
+  os << "matrix buffers: " << snapshot.allocations << " allocated, "
+     << snapshot.copies << " copies, " << snapshot.copy_then_discard
+     << " copy-then-discard, " << snapshot.live_buffers << " live ("
+     << snapshot.live_bytes << " bytes), peak " << snapshot.peak_bytes
+     << " bytes\n";
+  os << std::left << std::setw(32) << "tag" << std::right << std::setw(10)
+     << "allocs" << std::setw(14) << "bytes" << std::setw(10) << "copies"
+     << std::setw(14) << "copy bytes" << std::setw(10) << "discards"
+     << std::setw(14) << "discard bytes" << "\n";
+  for(const auto &entry : sorted){
+    const MatrixTraceTagStats &stats = entry.second;
+    os << std::left << std::setw(32) << entry.first << std::right
+       << std::setw(10) << stats.allocations << std::setw(14) << stats.bytes
+       << std::setw(10) << stats.copies << std::setw(14) << stats.copy_bytes
+       << std::setw(10) << stats.discards << std::setw(14)
+       << stats.discard_bytes << "\n";
+  }
+  os.flags(flags);
+}
+
+/**
+ * sets the counters and per tag stats to zero
+ */
+void ResetMatrixTrace() noexcept{
+  std::lock_guard<std::mutex> lock(trace_mutex);
+  tag_stats.clear();
+  size_t live_bytes = totals.live_bytes;
+  size_t live_count = totals.live_buffers;
+  totals = MatrixTraceTotals{0, 0, 0, live_count, live_bytes, live_bytes};
+}
+
+/**
+ * starts the tagged scope
+ * @param tag name of the call site
+ */
+MatrixTraceTag::MatrixTraceTag(const char* tag) noexcept
+    : _outer_tag(current_tag){
+  current_tag = tag;
+}
+
+/**
+ * restores the outer tag
+ */
+MatrixTraceTag::~MatrixTraceTag(){
+  current_tag = _outer_tag;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file MatrixTrace.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for the debug tracing of Matrix buffer allocations (build
+ * with -DMATRIX_ALLOC_TRACE)
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstddef>
+#include <ostream>
+
+#ifndef EX5__MATRIX_TRACE_H_
+#define EX5__MATRIX_TRACE_H_
+
+/**
+ * TRACE_UNTAGGED_NAME tag of allocations made outside all MATRIX_TRACE_TAG
+ * scopes
+ */
+#define TRACE_UNTAGGED_NAME "untagged"
+
+/**
+ * TraceKind the Matrix function that allocated a buffer:
+ * TRACE_CONSTRUCT- a constructor (rows/cols or default)
+ * TRACE_COPY- the copy constructor
+ * TRACE_ASSIGN- operator=
+ */
+enum TraceKind {TRACE_CONSTRUCT, TRACE_COPY, TRACE_ASSIGN};
+
+/**
+ * MatrixTraceTotals totals of all traced buffers
+ * allocations- buffers allocated
+ * copies- buffers allocated by the copy constructor or operator=
+ * copy_then_discard- copies whose source buffer was freed before the next
+ * allocation of the thread (the source was a temporary: the copy could have
+ * been avoided, e.g. with operator+= / operator*= or by constructing the
+ * result in place)
+ * live_buffers, live_bytes- buffers allocated and not freed yet
+ * peak_bytes- largest live_bytes seen
+ */
+struct MatrixTraceTotals
+{
+  size_t allocations;
+  size_t copies;
+  size_t copy_then_discard;
+  size_t live_buffers;
+  size_t live_bytes;
+  size_t peak_bytes;
+};
+
+/**
+ * MatrixTraceTagStats allocations made under one tag
+ * allocations, bytes- buffers allocated and their total size
+ * copies, copy_bytes- the ones allocated by the copy constructor or
+ * operator=
+ * discards, discard_bytes- the copies that were copy-then-discard (see
+ * MatrixTraceTotals)
+ */
+struct MatrixTraceTagStats
+{
+  size_t allocations;
+  size_t bytes;
+  size_t copies;
+  size_t copy_bytes;
+  size_t discards;
+  size_t discard_bytes;
+};
+
+/**
+ * records an allocation of a Matrix buffer
+ * @param buffer the new buffer
+ * @param bytes its size
+ * @param kind function that allocated it
+ * @param source buffer copied from (TRACE_COPY/TRACE_ASSIGN), nullptr
+ * otherwise
+ */
+void TraceMatrixAllocation(const void* buffer, size_t bytes, TraceKind kind,
+                           const void* source) noexcept;
+
+/**
+ * records the freeing of a traced buffer (untraced buffers are ignored)
+ * @param buffer buffer freed
+ */
+void TraceMatrixFree(const void* buffer) noexcept;
+
+/**
+ * @return totals of all traced buffers
+ */
+MatrixTraceTotals GetMatrixTraceTotals() noexcept;
+
+/**
+ * @param tag name of a tag (TRACE_UNTAGGED_NAME for the allocations made
+ * outside all tags)
+ * @return the tag's stats, all zero if nothing was allocated under it
+ */
+MatrixTraceTagStats GetMatrixTraceTagStats(const char* tag) noexcept;
+
+/**
+ * writes the totals and one line per tag: allocations, bytes, copies and
+ * copy-then-discard patterns (the tags with most bytes first)
+ * @param os stream to write to
+ */
+void DumpMatrixTrace(std::ostream& os);
+
+/**
+ * sets the counters and per tag stats to zero (buffers still alive stay
+ * traced and keep counting as live)
+ */
+void ResetMatrixTrace() noexcept;
+
+/**
+ * MatrixTraceTag names the call site of the allocations made (by this
+ * thread) until the scope ends. tags nest: the innermost one is used
+ */
+class MatrixTraceTag
+{
+ public:
+  /**
+   * starts the tagged scope
+   * @param tag name of the call site (a string literal: it is kept by
+   * pointer)
+   */
+  explicit MatrixTraceTag(const char* tag) noexcept;
+
+  /**
+   * restores the outer tag
+   */
+  ~MatrixTraceTag();
+
+  MatrixTraceTag(const MatrixTraceTag&) = delete;
+  MatrixTraceTag& operator=(const MatrixTraceTag&) = delete;
+
+ private:
+  const char* _outer_tag;
+};
+
+/**
+ * MATRIX_TRACE_STRINGIFY(x) / MATRIX_TRACE_LINE(x) turn __LINE__ into a
+ * string literal
+ */
+#define MATRIX_TRACE_STRINGIFY(x) #x
+#define MATRIX_TRACE_LINE(x) MATRIX_TRACE_STRINGIFY(x)
+
+/**
+ * MATRIX_TRACE_TAG(tag) tags the allocations of the rest of the enclosing
+ * block with tag
+ * MATRIX_TRACE_HERE() same, with "file:line" of the macro as the tag
+ * MATRIX_TRACE_ALLOCATION(buffer, bytes, kind, source) /
+ * MATRIX_TRACE_FREE(buffer) the hooks of Matrix.cc
+ * all compile to nothing when MATRIX_ALLOC_TRACE isn't defined
+ */
+#ifdef MATRIX_ALLOC_TRACE
+#define MATRIX_TRACE_TAG(tag) MatrixTraceTag matrix_trace_tag(tag)
+#define MATRIX_TRACE_HERE() \
+  MATRIX_TRACE_TAG(__FILE__ ":" MATRIX_TRACE_LINE(__LINE__))
+#define MATRIX_TRACE_ALLOCATION(buffer, bytes, kind, source) \
+  TraceMatrixAllocation(buffer, bytes, kind, source)
+#define MATRIX_TRACE_FREE(buffer) TraceMatrixFree(buffer)
+#else
+#define MATRIX_TRACE_TAG(tag) ((void)0)
+#define MATRIX_TRACE_HERE() ((void)0)
+#define MATRIX_TRACE_ALLOCATION(buffer, bytes, kind, source) ((void)0)
+#define MATRIX_TRACE_FREE(buffer) ((void)0)
+#endif
+
+
+#endif //EX5__MATRIX_TRACE_H_
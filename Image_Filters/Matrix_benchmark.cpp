@@ -0,0 +1,318 @@
+/**
+ * @file Matrix_benchmark.cpp
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief throughput benchmarks of Matrix operators and the image filters.
+ * sweeps square sizes from 3x3 up to 16k x 16k, prints GFLOP/s, GB/s and
+ * megapixels/s and optionally writes the results as JSON
+ * (usage: Matrix_benchmark [--max N] [--max-mul N] [--threads N]
+ * [--filter OP] [--json FILE|-])
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "Filters.h"
+#include "Matrix.h"
+#include "MatrixAllocator.h"
+#include "Parallel.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * BENCH_MIN_SECONDS every case is repeated until it ran at least this long
+ */
+#define BENCH_MIN_SECONDS 0.25
+
+/**
+ * BENCH_MAX_ITERATIONS maximal amount of repetitions of one case
+ */
+#define BENCH_MAX_ITERATIONS 100000
+
+/**
+ * DEFAULT_MAX_SIZE largest rows/cols benchmarked by default (--max)
+ */
+#define DEFAULT_MAX_SIZE 4096
+
+/**
+ * DEFAULT_MAX_MUL_SIZE largest rows/cols of operator* by default (--max-mul):
+ * 16k x 16k is ~8.8 TFLOP per product
+ */
+#define DEFAULT_MAX_MUL_SIZE 1024
+
+/**
+ * BENCH_LEVELS quantization levels used by the Quantization benchmark
+ */
+#define BENCH_LEVELS 4
+
+/**
+ * CONVOLUTION_FLOPS floating point operations of one 3x3 convolution cell
+ * (9 multiplications, 8 additions)
+ */
+#define CONVOLUTION_FLOPS 17
+
+/**
+ * sizes swept (rows = cols)
+ */
+static const size_t kSizes[] = {3, 16, 64, 256, 1024, 4096, 16384};
+
+/**
+ * BenchCase one benchmarked operation at one size
+ * name- operation name
+ * size- rows and cols of the input
+ * run- runs the operation once
+ * flops- floating point operations of one run (0 if not meaningful)
+ * bytes- bytes read and written by one run
+ */
+struct BenchCase {
+  std::string name;
+  size_t size;
+  std::function<void()> run;
+  double flops;
+  double bytes;
+};
+
+/**
+ * BenchResult timing of a case
+ */
+struct BenchResult {
+  size_t iterations;
+  double best_ns;
+  double mean_ns;
+};
+
+/**
+ * keeps results alive so the compiler can't drop the measured work
+ */
+static volatile float sink;
+
+/**
+ * fills a matrix with pixel like values (integers in [0, 255], fixed seed)
+ * @param matrix matrix to fill
+ */
+static void FillPixels(Matrix &matrix) noexcept{
+  uint32_t state = 12345;
+  size_t cells = matrix.GetRows() * matrix.GetCols();
+  float *data = matrix.GetMatrix();
+  for(size_t i = 0; i < cells; ++i){
+    state = state * 1664525u + 1013904223u;
+    data[i] = (float)(state >> 24);
+  }
+}
+
+/**
+ * runs a case until BENCH_MIN_SECONDS passed (after one warm up run)
+ * @param bench case to run
+ * @return amount of runs, best and mean time of one run
+ */
+static BenchResult Measure(const BenchCase &bench){
+  bench.run();
+  BenchResult result{0, 1e300, 0};
+  double total = 0;
+  while(total < BENCH_MIN_SECONDS * 1e9 &&
+        result.iterations < BENCH_MAX_ITERATIONS){
+    auto start = std::chrono::steady_clock::now();
+    bench.run();
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    if(ns < result.best_ns){
+      result.best_ns = ns;
+    }
+    total += ns;
+    result.iterations++;
+  }
+  result.mean_ns = total / result.iterations;
+  return result;
+}
+
+/**
+ * adds the cases of every operation at one size
+ * @param cases list to add to
+ * @param n rows and cols
+ * @param with_mul true to add operator* as well
+ */
+static void AddCases(std::vector<BenchCase> &cases, size_t n, bool with_mul){
+  //shared by the cases of this size, freed when the last case is destroyed
+  auto a = std::make_shared<Matrix>(n, n);
+  auto b = std::make_shared<Matrix>(n, n);
+  FillPixels(*a);
+  FillPixels(*b);
+  double cells = (double)n * n;
+  double cell_bytes = sizeof(float);
+  if(with_mul){
+    cases.push_back({"mul", n, [a, b](){ sink = ((*a) * (*b))[0]; },
+                     2 * cells * n, 3 * cells * cell_bytes});
+  }
+  cases.push_back({"add", n, [a, b](){ sink = ((*a) + (*b))[0]; },
+                   cells, 3 * cells * cell_bytes});
+  //add_assign changes its left side on every run, so it gets its own copy
+  //and the other cases keep reading the filled values
+  auto sum = std::make_shared<Matrix>(*a);
+  cases.push_back({"add_assign", n,
+                   [sum, b](){ *sum += *b; sink = (*sum)[0]; },
+                   cells, 3 * cells * cell_bytes});
+  cases.push_back({"scalar_mul", n, [a](){ sink = ((*a) * 0.5f)[0]; },
+                   cells, 2 * cells * cell_bytes});
+  cases.push_back({"blur", n, [b](){ sink = Blur(*b)[0]; },
+                   CONVOLUTION_FLOPS * cells, 2 * cells * cell_bytes});
+  //two convolutions and their sum
+  cases.push_back({"sobel", n, [b](){ sink = Sobel(*b)[0]; },
+                   (2 * CONVOLUTION_FLOPS + 1) * cells,
+                   2 * cells * cell_bytes});
+  cases.push_back({"quantization", n,
+                   [b](){ sink = Quantization(*b, BENCH_LEVELS)[0]; },
+                   0, 2 * cells * cell_bytes});
+}
+
+/**
+ * @return current local time as an ISO 8601 string
+ */
+static std::string Now(){
+  char buffer[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S",
+                std::localtime(&now));
+  return buffer;
+}
+
+/**
+ * writes the results as JSON (same layout idea as Google Benchmark's
+ * --benchmark_format=json: a context object and a list of benchmarks)
+ * @param out stream to write to
+ * @param cases benchmarked cases
+ * @param results their results (same order)
+ */
+static void WriteJson(std::FILE *out, const std::vector<BenchCase> &cases,
+                      const std::vector<BenchResult> &results){
+  std::fprintf(out, "{\n  \"context\": {\n");
+  std::fprintf(out, "    \"date\": \"%s\",\n", Now().c_str());
+  std::fprintf(out, "    \"threads\": %zu,\n", GetWorkerThreads());
+  std::fprintf(out, "    \"huge_page_mode\": %d,\n", (int)GetHugePageMode());
+  std::fprintf(out, "    \"cell_bytes\": %zu\n  },\n", sizeof(float));
+  std::fprintf(out, "  \"benchmarks\": [\n");
+  for(size_t i = 0; i < cases.size(); ++i){
+    const BenchCase &bench = cases[i];
+    const BenchResult &result = results[i];
+    double seconds = result.best_ns * 1e-9;
+    double cells = (double)bench.size * bench.size;
+    std::fprintf(out, "    {\"name\": \"%s/%zu\", \"op\": \"%s\", "
+                      "\"rows\": %zu, \"cols\": %zu, \"iterations\": %zu, "
+                      "\"best_ns\": %.1f, \"mean_ns\": %.1f, ",
+                 bench.name.c_str(), bench.size, bench.name.c_str(),
+                 bench.size, bench.size, result.iterations, result.best_ns,
+                 result.mean_ns);
+    if(bench.flops > 0){
+      std::fprintf(out, "\"gflops\": %.4f, ", bench.flops / seconds * 1e-9);
+    } else {
+      std::fprintf(out, "\"gflops\": null, ");
+    }
+    std::fprintf(out, "\"gbps\": %.4f, \"mpps\": %.4f}%s\n",
+                 bench.bytes / seconds * 1e-9, cells / seconds * 1e-6,
+                 i + 1 < cases.size() ? "," : "");
+  }
+  std::fprintf(out, "  ]\n}\n");
+}
+
+/**
+ * parses a positive size argument
+ * @param arg argument text
+ * @param value set to the parsed value
+ * @return true on success
+ */
+static bool ParseSize(const char *arg, size_t &value){
+  char *end = nullptr;
+  unsigned long long parsed = std::strtoull(arg, &end, 10);
+  if(end == arg || *end != '\0' || parsed == 0){
+    return false;
+  }
+  value = (size_t)parsed;
+  return true;
+}
+
+/**
+ * runs the benchmarks
+ * @param argc amount of arguments
+ * @param argv --max N (largest size), --max-mul N (largest operator* size),
+ * --threads N (worker threads), --filter OP (only this operation),
+ * --json FILE (also write JSON, "-" for stdout)
+ * @return 0 on success, 1 on bad arguments or an unwritable JSON file
+ */
+int main(int argc, char *argv[]){
+  size_t max_size = DEFAULT_MAX_SIZE;
+  size_t max_mul = DEFAULT_MAX_MUL_SIZE;
+  const char *json_path = nullptr;
+  const char *filter = nullptr;
+  for(int i = 1; i < argc; ++i){
+    bool has_value = i + 1 < argc;
+    size_t threads = 0;
+    if(has_value && std::strcmp(argv[i], "--max") == 0 &&
+       ParseSize(argv[i + 1], max_size)){
+      ++i;
+    } else if(has_value && std::strcmp(argv[i], "--max-mul") == 0 &&
+              ParseSize(argv[i + 1], max_mul)){
+      ++i;
+    } else if(has_value && std::strcmp(argv[i], "--threads") == 0 &&
+              ParseSize(argv[i + 1], threads)){
+      SetWorkerThreads(threads);
+      ++i;
+    } else if(has_value && std::strcmp(argv[i], "--filter") == 0){
+      filter = argv[++i];
+    } else if(has_value && std::strcmp(argv[i], "--json") == 0){
+      json_path = argv[++i];
+    } else {
+      std::fprintf(stderr, "usage: %s [--max N] [--max-mul N] [--threads N] "
+                           "[--filter OP] [--json FILE|-]\n", argv[0]);
+      return 1;
+    }
+  }
+  //the JSON goes to stdout alone when asked for
+  std::FILE *table = json_path != nullptr && std::strcmp(json_path, "-") == 0
+                     ? stderr : stdout;
+  std::vector<BenchCase> cases;
+  std::vector<BenchResult> results;
+  std::fprintf(table, "%-14s %7s %10s %14s %10s %10s %10s\n", "op", "size",
+               "iterations", "best ns", "GFLOP/s", "GB/s", "MP/s");
+  for(size_t n : kSizes){
+    if(n > max_size){
+      break;
+    }
+    std::vector<BenchCase> size_cases;
+    AddCases(size_cases, n, n <= max_mul);
+    for(BenchCase &bench : size_cases){
+      if(filter != nullptr && bench.name != filter){
+        continue;
+      }
+      BenchResult result = Measure(bench);
+      double seconds = result.best_ns * 1e-9;
+      std::fprintf(table, "%-14s %7zu %10zu %14.1f %10.3f %10.3f %10.3f\n",
+                   bench.name.c_str(), n, result.iterations, result.best_ns,
+                   bench.flops / seconds * 1e-9, bench.bytes / seconds * 1e-9,
+                   (double)n * n / seconds * 1e-6);
+      //the inputs aren't needed anymore, only the description is kept
+      bench.run = nullptr;
+      cases.push_back(bench);
+      results.push_back(result);
+    }
+  }
+  if(json_path != nullptr){
+    bool to_stdout = std::strcmp(json_path, "-") == 0;
+    std::FILE *out = to_stdout ? stdout : std::fopen(json_path, "w");
+    if(out == nullptr){
+      std::fprintf(stderr, "can't write %s\n", json_path);
+      return 1;
+    }
+    WriteJson(out, cases, results);
+    if(!to_stdout){
+      std::fclose(out);
+    }
+  }
+  return 0;
+}
@@ -1,5 +1,15 @@
 
 #include "Matrix.h"
+#include "SparseMatrix.h"
+#include "IntegralImage.h"
+#include "Convolution.h"
+#include "ColorImage.h"
+#include "Filters.h"
+#include "Parallel.h"
+#include "MatrixAllocator.h"
+#include "MatrixProfiler.h"
+#include "MatrixTrace.h"
+#include <cstdint>
 
 
 #define DIMENSION_ERR_MSG "Invalid matrix dimensions.\n"
@@ -11,7 +21,9 @@
 
 
 enum Failures {SUCCESS,TEST1FAIL, TEST2FAIL, TEST3FAIL, TEST4FAIL, TEST5FAIL,
-    TEST6FAIL, TEST7FAIL, TEST8FAIL};
+    TEST6FAIL, TEST7FAIL, TEST8FAIL, TEST9FAIL,
+    TEST10FAIL, TEST11FAIL, TEST12FAIL, TEST13FAIL, TEST14FAIL, TEST15FAIL,
+    TEST16FAIL, TEST17FAIL};
 
 int Test1();
 int Test2();
@@ -21,6 +33,15 @@ int Test5();
 int Test6();
 int Test7();
 int Test8();
+int Test9();
+int Test10();
+int Test11();
+int Test12();
+int Test13();
+int Test14();
+int Test15();
+int Test16();
+int Test17();
 
 int main() {
   std::cout<< "Test 1: constructors & destructors"<< std::endl;
@@ -89,12 +110,606 @@ int main() {
   }
   std::cout<< "TEST 8 PASSED!"<< std::endl<< std::endl;
 
+  std::cout << "Test 9: SparseMatrix conversions and sparse-dense operator *"
+  <<std::endl;
+  int test9_result = Test9();
+  if(test9_result != SUCCESS){
+    std::cout << "TEST 9 FAILED!"<< std::endl<< std::endl;
+    return test9_result;
+  }
+  std::cout<< "TEST 9 PASSED!"<< std::endl<< std::endl;
+
+  std::cout << "Test 10: DoubleMatrix and HalfMatrix"<<std::endl;
+  int test10_result = Test10();
+  if(test10_result != SUCCESS){
+    std::cout << "TEST 10 FAILED!"<< std::endl<< std::endl;
+    return test10_result;
+  }
+  std::cout<< "TEST 10 PASSED!"<< std::endl<< std::endl;
+
+  std::cout << "Test 11: integral image, box filters and local statistics"
+  <<std::endl;
+  int test11_result = Test11();
+  if(test11_result != SUCCESS){
+    std::cout << "TEST 11 FAILED!"<< std::endl<< std::endl;
+    return test11_result;
+  }
+  std::cout<< "TEST 11 PASSED!"<< std::endl<< std::endl;
+
+  std::cout << "Test 12: direct and FFT convolution"<<std::endl;
+  int test12_result = Test12();
+  if(test12_result != SUCCESS){
+    std::cout << "TEST 12 FAILED!"<< std::endl<< std::endl;
+    return test12_result;
+  }
+  std::cout<< "TEST 12 PASSED!"<< std::endl<< std::endl;
+
+  std::cout << "Test 13: ColorImage layouts and filters"<<std::endl;
+  int test13_result = Test13();
+  if(test13_result != SUCCESS){
+    std::cout << "TEST 13 FAILED!"<< std::endl<< std::endl;
+    return test13_result;
+  }
+  std::cout<< "TEST 13 PASSED!"<< std::endl<< std::endl;
+
+  std::cout << "Test 14: persistent worker pool"<<std::endl;
+  int test14_result = Test14();
+  if(test14_result != SUCCESS){
+    std::cout << "TEST 14 FAILED!"<< std::endl<< std::endl;
+    return test14_result;
+  }
+  std::cout<< "TEST 14 PASSED!"<< std::endl<< std::endl;
+
+  std::cout << "Test 15: huge page allocation policy"<<std::endl;
+  int test15_result = Test15();
+  if(test15_result != SUCCESS){
+    std::cout << "TEST 15 FAILED!"<< std::endl<< std::endl;
+    return test15_result;
+  }
+  std::cout<< "TEST 15 PASSED!"<< std::endl<< std::endl;
+
+#ifdef MATRIX_PROFILING
+  std::cout << "Test 16: profiling counters"<<std::endl;
+  int test16_result = Test16();
+  if(test16_result != SUCCESS){
+    std::cout << "TEST 16 FAILED!"<< std::endl<< std::endl;
+    return test16_result;
+  }
+  std::cout<< "TEST 16 PASSED!"<< std::endl<< std::endl;
+#endif
+
+#ifdef MATRIX_ALLOC_TRACE
+  std::cout << "Test 17: allocation tracing"<<std::endl;
+  int test17_result = Test17();
+  if(test17_result != SUCCESS){
+    std::cout << "TEST 17 FAILED!"<< std::endl<< std::endl;
+    return test17_result;
+  }
+  std::cout<< "TEST 17 PASSED!"<< std::endl<< std::endl;
+#endif
+
 
   std::cout <<"ALL TESTS PASSED! :)"<<std::endl;
   // TODO missing vectorize and print
   // TODO add check for >> if the input not in one line
 
 }
+#ifdef MATRIX_ALLOC_TRACE
+int Test17() {
+  //float cells: a 4x5 matrix has 80 bytes
+  ResetMatrixTrace();
+  MatrixTraceTotals before = GetMatrixTraceTotals();
+  Matrix a(4,5);
+  Matrix b(4,5);
+  {
+    //m = a + b: the sum is copied into m and freed right away (peak: a, b,
+    //m, the sum and its copy)
+    MATRIX_TRACE_TAG("test assign");
+    Matrix m(4,5);
+    m = a + b;
+  }
+  {
+    //the sum is built in c: no copy. d copies c, which outlives the next
+    //allocation (the inner tag's), so d isn't copy-then-discard
+    MATRIX_TRACE_TAG("test elided");
+    Matrix c = a + b;
+    Matrix d(c);
+    {
+      MATRIX_TRACE_TAG("test inner");
+      Matrix e(2,2);
+    }
+  }
+  MatrixTraceTagStats untagged = GetMatrixTraceTagStats(TRACE_UNTAGGED_NAME);
+  MatrixTraceTagStats assign = GetMatrixTraceTagStats("test assign");
+  MatrixTraceTagStats elided = GetMatrixTraceTagStats("test elided");
+  MatrixTraceTagStats inner = GetMatrixTraceTagStats("test inner");
+  MatrixTraceTotals after = GetMatrixTraceTotals();
+  if(untagged.allocations != 2 || untagged.bytes != 160 ||
+  untagged.copies != 0 ||
+  assign.allocations != 3 || assign.bytes != 240 || assign.copies != 1 ||
+  assign.copy_bytes != 80 || assign.discards != 1 ||
+  assign.discard_bytes != 80 ||
+  elided.allocations != 2 || elided.bytes != 160 || elided.copies != 1 ||
+  elided.discards != 0 ||
+  inner.allocations != 1 || inner.bytes != 16 || inner.copies != 0 ||
+  GetMatrixTraceTagStats("no such tag").allocations != 0){
+    DumpMatrixTrace(std::cerr);
+    return TEST17FAIL;
+  }
+  if(after.allocations != 8 || after.copies != 2 ||
+  after.copy_then_discard != 1 ||
+  after.live_buffers != before.live_buffers + 2 ||
+  after.live_bytes != before.live_bytes + 160 ||
+  after.peak_bytes != before.live_bytes + 400){
+    DumpMatrixTrace(std::cerr);
+    return TEST17FAIL;
+  }
+  return SUCCESS;
+}
+#endif
+
+#ifdef MATRIX_PROFILING
+int Test16() {
+  //float cells: a 4x5 matrix has 80 bytes, a 3x3 one 36
+  ResetOpProfiles();
+  Matrix a(4,5);
+  Matrix b(4,5);
+  Matrix c = a + b;
+  c += a;
+  //scalar operator* copies: the copy is counted again as PROFILE_COPY
+  Matrix d = c * 2.0f;
+  d /= 2.0f;
+  //operator*= is operator* and an operator= (PROFILE_COPY)
+  Matrix square(3,3);
+  square *= square;
+  //nested calls count in the outer and the inner operation: Blur's
+  //convolution and Sobel's two convolutions and operator+
+  Matrix blurred = Blur(a);
+  Matrix edges = Sobel(a);
+  const size_t calls[PROFILE_OP_COUNT] = {1, 3, 2, 2, 3, 1, 1, 0, 0, 0};
+  const size_t allocated[PROFILE_OP_COUNT] = {36, 160, 0, 116, 0, 116, 232,
+                                              0, 0, 196};
+  const size_t moved[PROFILE_OP_COUNT] = {108, 720, 320, 232, 480, 160, 160,
+                                          0, 0, 0};
+  for(int i = 0; i < PROFILE_OP_COUNT; ++i){
+    OpProfile profile = GetOpProfile((ProfiledOp)i);
+    if(profile.calls != calls[i] || profile.bytes_allocated != allocated[i]
+    || profile.bytes_moved != moved[i]){
+      std::cerr << GetOpName((ProfiledOp)i) << ": " << profile.calls
+      << " calls, " << profile.bytes_allocated << " bytes allocated, "
+      << profile.bytes_moved << " bytes moved" << std::endl;
+      return TEST16FAIL;
+    }
+  }
+  ResetOpProfiles();
+  if(GetOpProfile(PROFILE_SOBEL).calls != 0){
+    return TEST16FAIL;
+  }
+  return SUCCESS;
+}
+#endif
+
+int Test15() {
+  //huge pages for every buffer of at least 4KB
+  SetHugePagePolicy(HUGE_PAGES_TRANSPARENT, 4096);
+  HugePageCounters before = GetHugePageCounters();
+  Matrix small(4,4);
+  Matrix large(100,100);
+  HugePageCounters after = GetHugePageCounters();
+  if(GetBufferKind(small.GetMatrix()) != BUFFER_HEAP ||
+  after.heap != before.heap + 1 ||
+  (uintptr_t)small.GetMatrix() % 64 != 0){
+    std::cerr << "small buffer wasn't allocated from the heap" << std::endl;
+    SetHugePagePolicy(HUGE_PAGES_TRANSPARENT);
+    return TEST15FAIL;
+  }
+#ifdef __linux__
+  //the cells start the mapping: 2MB aligned, no header in front of them
+  if(GetBufferKind(large.GetMatrix()) != BUFFER_TRANSPARENT_HUGE ||
+  after.transparent_advised != before.transparent_advised + 1 ||
+  (uintptr_t)large.GetMatrix() % (2 << 20) != 0){
+    std::cerr << "large buffer wasn't mapped for huge pages" << std::endl;
+    SetHugePagePolicy(HUGE_PAGES_TRANSPARENT);
+    return TEST15FAIL;
+  }
+  //explicit huge pages: either the hugetlbfs pool or a counted fallback
+  SetHugePagePolicy(HUGE_PAGES_EXPLICIT, 4096);
+  Matrix explicit_huge(100,100);
+  HugePageCounters last = GetHugePageCounters();
+  BufferKind kind = GetBufferKind(explicit_huge.GetMatrix());
+  if(!(kind == BUFFER_EXPLICIT_HUGE && last.explicit_huge ==
+  after.explicit_huge + 1) && !(kind == BUFFER_TRANSPARENT_HUGE &&
+  last.fallbacks == after.fallbacks + 1)){
+    std::cerr << "explicit huge page allocation wasn't counted" << std::endl;
+    SetHugePagePolicy(HUGE_PAGES_TRANSPARENT);
+    return TEST15FAIL;
+  }
+#endif
+  SetHugePagePolicy(HUGE_PAGES_OFF, 4096);
+  Matrix heap(100,100);
+  SetHugePagePolicy(HUGE_PAGES_TRANSPARENT);
+  if(GetBufferKind(heap.GetMatrix()) != BUFFER_HEAP){
+    std::cerr << "HUGE_PAGES_OFF buffer wasn't allocated from the heap"
+    << std::endl;
+    return TEST15FAIL;
+  }
+  //mapped and heap buffers are freed by their own kind
+  large = small;
+  heap = small;
+  if(large != small || heap != small){
+    std::cerr << "assignment over mapped buffers failed" << std::endl;
+    return TEST15FAIL;
+  }
+  return SUCCESS;
+}
+
+int Test14() {
+  //a persistent pool of 4 pinned workers against the calling thread alone
+  Matrix a(300,300);
+  Matrix b(300,300);
+  for(size_t i = 0; i < 90000; ++i){
+    a[i] = (float)(i % 97);
+    b[i] = (float)(i % 89);
+  }
+  SetWorkerThreads(1);
+  Matrix serial_sum = a + b;
+  Matrix serial_scaled = 0.5f * a;
+  Matrix serial_blur = Blur(a);
+  SetWorkerThreads(4);
+  SetThreadPinning(true);
+  if(GetWorkerThreads() != 4){
+    std::cerr << "SetWorkerThreads was ignored" << std::endl;
+    return TEST14FAIL;
+  }
+  for(int round = 0; round < 3; ++round){
+    Matrix copy = a;
+    copy += b;
+    if(a + b != serial_sum || copy != serial_sum || 0.5f * a !=
+    serial_scaled || Blur(a) != serial_blur){
+      std::cerr << "worker pool changed the results" << std::endl;
+      SetWorkerThreads(0);
+      SetThreadPinning(false);
+      return TEST14FAIL;
+    }
+  }
+  //a call from inside a worker runs serially instead of waiting on the pool
+  std::vector<int> visited(300 * 300, 0);
+  ParallelRows(300, 300, [&visited](size_t first, size_t last){
+    for(size_t i = first; i < last; ++i){
+      ParallelRows(300, 300, [&visited, i](size_t inner_first,
+          size_t inner_last){
+        for(size_t j = inner_first; j < inner_last; ++j){
+          visited[i * 300 + j]++;
+        }
+      });
+    }
+  });
+  SetWorkerThreads(0);
+  SetThreadPinning(false);
+  for(int count : visited){
+    if(count != 1){
+      std::cerr << "nested ParallelRows missed or repeated rows" << std::endl;
+      return TEST14FAIL;
+    }
+  }
+  return SUCCESS;
+}
+
+int Test13() {
+  std::vector<Matrix> channels;
+  for(size_t c = 0; c < 3; ++c){
+    Matrix channel(9,11);
+    for(size_t i = 0; i < 99; ++i){
+      channel[i] = (float)((i * 37 + c * 101) % 256);
+    }
+    channels.push_back(channel);
+  }
+  ColorImage interleaved(channels);
+  ColorImage planar = interleaved.ToLayout(PLANAR);
+  if(interleaved.GetData()[3] != channels[0](0,1) ||
+  planar.GetData()[99] != channels[1](0,0) ||
+  planar(8,10,2) != channels[2](8,10)){
+    std::cerr << "ColorImage layout is incorrect" << std::endl;
+    return TEST13FAIL;
+  }
+  //every channel of the multi-channel filters against the Matrix filters
+  for(const ColorImage &image : {interleaved, planar}){
+    ColorImage blurred = Blur(image);
+    ColorImage sobel = Sobel(image);
+    ColorImage quantized = Quantization(image, 5);
+    for(size_t c = 0; c < 3; ++c){
+      Matrix blur_expected = Blur(channels[c]);
+      Matrix sobel_expected = Sobel(channels[c]);
+      Matrix quantization_expected = Quantization(channels[c], 5);
+      Matrix blur_channel = blurred.GetChannel(c);
+      Matrix sobel_channel = sobel.GetChannel(c);
+      Matrix quantization_channel = quantized.GetChannel(c);
+      for(size_t i = 0; i < 99; ++i){
+        if(blur_channel[i] != blur_expected[i] ||
+        sobel_channel[i] != sobel_expected[i] ||
+        quantization_channel[i] != quantization_expected[i]){
+          std::cerr << "ColorImage filter differs from Matrix filter"
+          << std::endl;
+          return TEST13FAIL;
+        }
+      }
+    }
+  }
+  try{
+    ColorImage too_many(2, 2, COLOR_MAX_CHANNELS + 1);
+    std::cerr << "ColorImage accepted too many channels" << std::endl;
+    return TEST13FAIL;
+  }catch (const MatrixException &err){}
+  try{
+    interleaved(9,0,0) = 1;
+    std::cerr << "ColorImage operator() didn't check the range" << std::endl;
+    return TEST13FAIL;
+  }catch (const MatrixException &err){}
+  return SUCCESS;
+}
+
+int Test12() {
+  Matrix identity(3,3);
+  identity(1,1) = 1;
+  if(ChooseConvolutionMethod(identity) != CONVOLUTION_DIRECT ||
+  ChooseConvolutionMethod(Matrix(3,FFT_KERNEL_THRESHOLD + 1)) !=
+  CONVOLUTION_FFT){
+    std::cerr << "ChooseConvolutionMethod picked the wrong method"
+    << std::endl;
+    return TEST12FAIL;
+  }
+  //image smaller than the kernel, odd sizes and a non-square even kernel
+  size_t sizes[][4] = {{5,3,9,9}, {37,53,20,17}, {70,41,4,33}};
+  for(auto &size : sizes){
+    Matrix image(size[0],size[1]);
+    for(size_t i = 0; i < size[0] * size[1]; ++i){
+      image[i] = (float)((i * 37) % 256);
+    }
+    Matrix kernel(size[2],size[3]);
+    float kernel_sum = 0;
+    for(size_t i = 0; i < size[2] * size[3]; ++i){
+      kernel[i] = (float)((int)(i % 7) - 3) / 8;
+      kernel_sum += std::fabs(kernel[i]);
+    }
+    Matrix direct = Convolve(image, kernel, CONVOLUTION_DIRECT);
+    Matrix fft = Convolve(image, kernel, CONVOLUTION_FFT);
+    if(direct.GetRows() != size[0] || fft.GetCols() != size[1]){
+      std::cerr << "Convolve has wrong dimensions" << std::endl;
+      return TEST12FAIL;
+    }
+    //(0,0) against a direct sum
+    float corner = 0;
+    for(size_t i = size[2] / 2; i < size[2] && i - size[2] / 2 < size[0]; ++i){
+      for(size_t j = size[3] / 2; j < size[3] && j - size[3] / 2 < size[1];
+      ++j){
+        corner += kernel(i,j) * image(i - size[2] / 2,j - size[3] / 2);
+      }
+    }
+    if(std::fabs(direct(0,0) - corner) > 1e-2){
+      std::cerr << "direct Convolve returned incorrect result" << std::endl;
+      return TEST12FAIL;
+    }
+    for(size_t i = 0; i < size[0] * size[1]; ++i){
+      if(std::fabs(direct[i] - fft[i]) > FFT_TOLERANCE * 255 * kernel_sum){
+        std::cerr << "FFT Convolve differs from direct Convolve" << std::endl;
+        return TEST12FAIL;
+      }
+    }
+  }
+  //the identity kernel returns the image
+  Matrix image(20,30);
+  for(size_t i = 0; i < 600; ++i){
+    image[i] = (float)(i % 256);
+  }
+  Matrix same = Convolve(image, identity);
+  for(size_t i = 0; i < 600; ++i){
+    if(same[i] != image[i]){
+      std::cerr << "Convolve with identity changed the image" << std::endl;
+      return TEST12FAIL;
+    }
+  }
+  return SUCCESS;
+}
+
+int Test11() {
+  Matrix image(5,7);
+  for(size_t i = 0; i < 35; ++i){
+    image[i] = (float)((i * 37) % 256);
+  }
+  DoubleMatrix integral = IntegralImage(image);
+  if(integral.GetRows() != 6 || integral.GetCols() != 8 ||
+  integral(0,3) != 0 || integral(2,0) != 0){
+    std::cerr << "IntegralImage has wrong dimensions or padding" << std::endl;
+    return TEST11FAIL;
+  }
+  //every box against a direct sum
+  for(size_t r0 = 0; r0 < 5; ++r0){
+    for(size_t c0 = 0; c0 < 7; ++c0){
+      for(size_t r1 = r0 + 1; r1 <= 5; ++r1){
+        for(size_t c1 = c0 + 1; c1 <= 7; ++c1){
+          double sum = 0;
+          for(size_t i = r0; i < r1; ++i){
+            for(size_t j = c0; j < c1; ++j){
+              sum += image(i,j);
+            }
+          }
+          if(BoxSum(integral, r0, c0, r1, c1) != sum){
+            std::cerr << "BoxSum returned incorrect result" << std::endl;
+            return TEST11FAIL;
+          }
+        }
+      }
+    }
+  }
+  //radius 1 clipped windows: corner (0,0) averages 4 cells
+  Matrix mean = LocalMean(image, 1);
+  float corner = (image(0,0) + image(0,1) + image(1,0) + image(1,1)) / 4;
+  if(std::fabs(mean(0,0) - corner) > 1e-4 ||
+  BoxBlur(image, 1)(0,0) != std::rint(corner)){
+    std::cerr << "LocalMean/BoxBlur returned incorrect result" << std::endl;
+    return TEST11FAIL;
+  }
+  //a window covering the whole image everywhere
+  Matrix whole = LocalMean(image, 10);
+  Matrix widest = LocalMean(image, SIZE_MAX);
+  if(std::fabs(whole(4,6) - BoxSum(integral, 0, 0, 5, 7) / 35) > 1e-4 ||
+  widest(0,0) != whole(0,0) || widest(4,6) != whole(4,6)){
+    std::cerr << "LocalMean with large radius is incorrect" << std::endl;
+    return TEST11FAIL;
+  }
+  Matrix flat(4,4);
+  flat += 7;
+  Matrix deviation = LocalStdDev(flat, 2);
+  Matrix threshold = LocalMeanThreshold(flat, 1, 1);
+  for(size_t i = 0; i < 16; ++i){
+    if(deviation[i] != 0 || threshold[i] != 255){
+      std::cerr << "LocalStdDev/LocalMeanThreshold returned incorrect result"
+      << std::endl;
+      return TEST11FAIL;
+    }
+  }
+  if(LocalMeanThreshold(flat, 1, -1)[5] != 0){
+    std::cerr << "LocalMeanThreshold offset is ignored" << std::endl;
+    return TEST11FAIL;
+  }
+  return SUCCESS;
+}
+
+int Test10() {
+  //1 + 1e-8 is lost in float but kept in double
+  DoubleMatrix row(1,2);
+  DoubleMatrix col(2,1);
+  row(0,0) = 1;
+  row(0,1) = 1e-8;
+  col(0,0) = 1;
+  col(1,0) = 1;
+  DoubleMatrix product = row * col;
+  if(product(0,0) == 1 || product(0,0) != 1 + 1e-8){
+    std::cerr << "DoubleMatrix multiplication lost precision" << std::endl;
+    return TEST10FAIL;
+  }
+  DoubleMatrix doubled = 2 * row;
+  if(doubled(0,1) != 2e-8){
+    std::cerr << "DoubleMatrix scalar multiplication failed" << std::endl;
+    return TEST10FAIL;
+  }
+
+  HalfMatrix h1(3,3);
+  HalfMatrix h2(3,3);
+  for(int i = 0; i < 9; ++i){
+    h1[i] = 2;
+    h2[i] = 0.5f;
+  }
+  HalfMatrix h3 = h1 * h2;
+  for(int i = 0; i < 9; ++i){
+    if((float)h3[i] != 3){
+      std::cerr << "HalfMatrix multiplication returned incorrect result" <<
+      std::endl;
+      return TEST10FAIL;
+    }
+  }
+  h3 += 0.25f;
+  if((float)h3(1,1) != 3.25f || h3.GetMatrix()[0].GetBits() != 0x4280){
+    std::cerr << "HalfMatrix addition or storage is incorrect" << std::endl;
+    return TEST10FAIL;
+  }
+  //1/3 is rounded to 11 significant bits when stored
+  h3 /= 3;
+  if((float)h3[0] == 3.25f / 3 || std::fabs((float)h3[0] - 3.25f / 3) >
+  1e-3){
+    std::cerr << "HalfMatrix division isnt rounded to half precision" <<
+    std::endl;
+    return TEST10FAIL;
+  }
+  return SUCCESS;
+}
+
+int Test9() {
+  Matrix dense(4,5);
+  float* dense_vals = dense.GetMatrix();
+  dense_vals[1] = 3;
+  dense_vals[7] = -2;
+  dense_vals[13] = 5;
+  dense_vals[19] = 1;
+
+  SparseMatrix csr(dense);
+  SparseMatrix csc(dense, CSC);
+  if(csr.GetNonZeros() != 4 || csc.GetNonZeros() != 4){
+    std::cerr << "sparse matrix stored incorrect amount of non-zeros"
+              << std::endl;
+    return TEST9FAIL;
+  }
+  if(csr.ToDense() != dense || csc.ToDense() != dense){
+    std::cerr << "ToDense didnt restore the original matrix" << std::endl;
+    return TEST9FAIL;
+  }
+  if(csr != csc || csr.ToFormat(CSC).ToDense() != dense ||
+     csc.ToFormat(CSR).ToDense() != dense){
+    std::cerr << "ToFormat conversion gave incorrect result" << std::endl;
+    return TEST9FAIL;
+  }
+  if(csr(1,2) != -2 || csc(3,4) != 1 || csr(0,0) != 0){
+    std::cerr << "sparse operator () returned incorrect value" << std::endl;
+    return TEST9FAIL;
+  }
+
+  Matrix right(5,3);
+  float* right_vals = right.GetMatrix();
+  for(int i = 0; i < 15; ++i){
+    right_vals[i] = (float)i;
+  }
+  Matrix vec(5,1);
+  float* vec_vals = vec.GetMatrix();
+  for(int i = 0; i < 5; ++i){
+    vec_vals[i] = (float)(i + 1);
+  }
+  if(csr * right != dense * right || csc * right != dense * right ||
+     csr * vec != dense * vec || csc * vec != dense * vec){
+    std::cerr << "sparse * dense returned incorrect result" << std::endl;
+    return TEST9FAIL;
+  }
+
+  Matrix left(3,4);
+  float* left_vals = left.GetMatrix();
+  for(int i = 0; i < 12; ++i){
+    left_vals[i] = (float)(i % 5);
+  }
+  if(left * csr != left * dense || left * csc != left * dense){
+    std::cerr << "dense * sparse returned incorrect result" << std::endl;
+    return TEST9FAIL;
+  }
+
+  try{
+    Matrix bad = csr * left;
+  }catch (const MatrixException &err){
+    std::string err_msg = err.what();
+    if(err_msg != DIMENSION_ERR_MSG){
+      std::cerr <<"sparse operator * threw incorrect string for error" <<
+                std::endl;
+      return TEST9FAIL;
+    }
+  }
+  catch(const std::exception &err){
+    std::cerr <<"wrong exception thrown in sparse operator *"<<std::endl;
+    return TEST9FAIL;
+  }
+  //indices are 32 bit: a dimension they can't address is rejected
+  try{
+    SparseMatrix too_wide(1, SPARSE_MAX_DIMENSION + 1);
+    std::cerr << "SparseMatrix accepted a dimension above "
+                 "SPARSE_MAX_DIMENSION" << std::endl;
+    return TEST9FAIL;
+  }catch (const MatrixException &err){
+    std::string err_msg = err.what();
+    if(err_msg != DIMENSION_ERR_MSG){
+      std::cerr <<"SparseMatrix threw incorrect string for error" <<
+                std::endl;
+      return TEST9FAIL;
+    }
+  }
+  return SUCCESS;
+}
+
 int Test8() {
   Matrix mat(4,4);
   std::cin >> mat;
@@ -553,6 +1168,30 @@ int Test1() {
     std::cerr << "wrong exception thrown in constructor" << std::endl;
     return TEST1FAIL;
   }
+  try{
+    Matrix overflowing(SIZE_MAX / 2, 4);
+    std::cerr << "rows*cols overflow wasnt detected" << std::endl;
+    return TEST1FAIL;
+  }catch(const MatrixException &err){
+    const std::string err_string = err.what();
+    if(err_string !=BAD_ALLOC_ERR_MSG){
+      std::cerr << "check exception in size overflow- wrong string" <<
+      std::endl;
+      return TEST1FAIL;
+    }
+  }
+  try{
+    Matrix negative(-1, 4);
+    std::cerr << "negative dimension wasnt detected" << std::endl;
+    return TEST1FAIL;
+  }catch(const MatrixException &err){
+    const std::string err_string = err.what();
+    if(err_string != DIMENSION_ERR_MSG){
+      std::cerr << "check exception in negative dimension- wrong string" <<
+      std::endl;
+      return TEST1FAIL;
+    }
+  }
   return SUCCESS;
 }
 
@@ -0,0 +1,283 @@
+/**
+ * @file Parallel.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for Parallel.h file
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "Parallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * worker_threads amount of workers, 0 means hardware_concurrency
+ */
+static std::atomic<size_t> worker_threads(0);
+
+/**
+ * pin_threads whether workers are pinned to cpus
+ */
+static std::atomic<bool> pin_threads(false);
+
+/**
+ * pins the calling thread to the worker-th cpu allowed for the process
+ * (wrapping around if there are more workers than cpus)
+ * @param worker index of the worker
+ */
+static void PinToCpu(size_t worker) noexcept{
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0){
+    return;
+  }
+  size_t cpu_amount = CPU_COUNT(&allowed);
+  if(cpu_amount == 0){
+    return;
+  }
+  size_t wanted = worker % cpu_amount;
+  for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu){
+    if(!CPU_ISSET(cpu, &allowed)){
+      continue;
+    }
+    if(wanted-- == 0){
+      cpu_set_t single;
+      CPU_ZERO(&single);
+      CPU_SET(cpu, &single);
+      pthread_setaffinity_np(pthread_self(), sizeof(single), &single);
+      return;
+    }
+  }
+#else
+  (void)worker;
+#endif
+}
+
+/**
+ * sets the number of worker threads used by ParallelRows.
+ * @param threads amount of workers, 0 restores the default
+ * (std::thread::hardware_concurrency)
+ */
+void SetWorkerThreads(size_t threads) noexcept{
+  worker_threads = threads;
+}
+
+/**
+ * @return number of worker threads used by ParallelRows
+ */
+size_t GetWorkerThreads() noexcept{
+  size_t threads = worker_threads;
+  if(threads == 0){
+    threads = std::thread::hardware_concurrency();
+  }
+  return threads == 0 ? 1 : threads;
+}
+
+/**
+ * turns pinning of worker threads on/off
+ * @param pin true to pin workers, false to let the scheduler place them
+ */
+void SetThreadPinning(bool pin) noexcept{
+  pin_threads = pin;
+}
+
+/**
+ * @return true if worker threads are pinned
+ */
+bool GetThreadPinning() noexcept{
+  return pin_threads;
+}
+
+/**
+ * WorkerPool persistent worker threads of ParallelRows. worker i always runs
+ * chunk i of a call, so a row chunk is first touched and later processed by
+ * the same thread (and, if pinned, the same cpu). the pool is started on the
+ * first parallel call and restarted only when the amount of workers or the
+ * pinning changes
+ */
+class WorkerPool
+{
+ public:
+  WorkerPool() : _pinned(false), _stopping(false), _generation(0),
+                 _pending(0), _func(nullptr), _rows(0) {}
+
+  ~WorkerPool(){
+    Stop();
+  }
+
+  /**
+   * runs func over [0, rows) in threads chunks, one per worker, and waits
+   * for all of them
+   * @param threads amount of workers (chunks)
+   * @param pin true if the workers should be pinned
+   * @param rows number of rows to split
+   * @param func called as func(first_row, last_row) for every non empty chunk
+   * @return false if nothing was run: the pool couldn't be started, another
+   * call is running, or this is a call from inside a worker
+   */
+  bool Run(size_t threads, bool pin, size_t rows,
+           const std::function<void(size_t, size_t)>& func) noexcept;
+
+ private:
+  std::mutex _mutex;
+  std::condition_variable _start;
+  std::condition_variable _done;
+  std::vector<std::thread> _workers;
+  bool _pinned;
+  bool _stopping;
+  //incremented for every call, workers wait for a generation they haven't
+  //run yet
+  size_t _generation;
+  size_t _pending;
+  const std::function<void(size_t, size_t)> *_func;
+  size_t _rows;
+
+  /**
+   * starts the workers (may throw, Stop cleans up the started ones)
+   * @param threads amount of workers
+   * @param pin true to pin every worker to its cpu
+   */
+  void Start(size_t threads, bool pin);
+
+  /**
+   * stops and joins all workers
+   */
+  void Stop() noexcept;
+
+  /**
+   * body of a worker: waits for calls and runs its chunk of each
+   * @param index index of the worker
+   * @param seen generation at the worker's start
+   */
+  void WorkerLoop(size_t index, size_t seen) noexcept;
+};
+
+/**
+ * dispatch_mutex one ParallelRows call at a time uses the pool
+ */
+static std::mutex dispatch_mutex;
+
+/**
+ * in_worker true on the pool's threads (nested calls run serially)
+ */
+static thread_local bool in_worker = false;
+
+/**
+ * @return the pool used by ParallelRows
+ */
+static WorkerPool& GetPool() noexcept{
+  static WorkerPool pool;
+  return pool;
+}
+
+void WorkerPool::Start(size_t threads, bool pin){
+  _pinned = pin;
+  _workers.reserve(threads);
+  size_t seen = _generation;
+  for(size_t i = 0; i < threads; ++i){
+    _workers.emplace_back([this, i, pin, seen](){
+      in_worker = true;
+      if(pin){
+        PinToCpu(i);
+      }
+      WorkerLoop(i, seen);
+    });
+  }
+}
+
+void WorkerPool::Stop() noexcept{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _start.notify_all();
+  for(auto &worker : _workers){
+    worker.join();
+  }
+  _workers.clear();
+  _stopping = false;
+}
+
+void WorkerPool::WorkerLoop(size_t index, size_t seen) noexcept{
+  std::unique_lock<std::mutex> lock(_mutex);
+  while(true){
+    _start.wait(lock, [this, &seen](){
+      return _stopping || _generation != seen;
+    });
+    if(_stopping){
+      return;
+    }
+    seen = _generation;
+    size_t threads = _workers.size();
+    size_t first = index * _rows / threads;
+    size_t last = (index + 1) * _rows / threads;
+    const std::function<void(size_t, size_t)> *func = _func;
+    lock.unlock();
+    if(first < last){
+      (*func)(first, last);
+    }
+    lock.lock();
+    if(--_pending == 0){
+      _done.notify_one();
+    }
+  }
+}
+
+bool WorkerPool::Run(size_t threads, bool pin, size_t rows,
+                     const std::function<void(size_t, size_t)>& func)
+                     noexcept{
+  if(in_worker){
+    return false;
+  }
+  std::unique_lock<std::mutex> dispatch(dispatch_mutex, std::try_to_lock);
+  if(!dispatch.owns_lock()){
+    return false;
+  }
+  if(_workers.size() != threads || _pinned != pin){
+    Stop();
+    try{
+      Start(threads, pin);
+    }catch(...){
+      //no memory or no more threads: the caller does the work itself
+      Stop();
+      return false;
+    }
+  }
+  std::unique_lock<std::mutex> lock(_mutex);
+  _func = &func;
+  _rows = rows;
+  _pending = threads;
+  _generation++;
+  _start.notify_all();
+  _done.wait(lock, [this](){
+    return _pending == 0;
+  });
+  return true;
+}
+
+/**
+ * runs func over [0, rows) split into GetWorkerThreads() contiguous chunks,
+ * chunk i always given to worker i of the persistent pool
+ * @param rows number of rows to split
+ * @param cols number of columns in every row (used for the size threshold)
+ * @param func called as func(first_row, last_row) for every non empty chunk
+ */
+void ParallelRows(size_t rows, size_t cols,
+                  const std::function<void(size_t, size_t)>& func) noexcept{
+  size_t threads = GetWorkerThreads();
+  if(threads <= 1 || rows <= 1 || rows * cols < PARALLEL_MIN_CELLS ||
+     !GetPool().Run(threads, pin_threads, rows, func)){
+    func(0, rows);
+  }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file Parallel.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for the row partitioning used by Matrix and the filters
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstddef>
+#include <functional>
+
+#ifndef EX5__PARALLEL_H_
+#define EX5__PARALLEL_H_
+
+/**
+ * PARALLEL_MIN_CELLS matrices with fewer cells are processed by the calling
+ * thread only (waking the workers costs more than the work itself)
+ */
+#define PARALLEL_MIN_CELLS (1u << 16)
+
+/**
+ * sets the number of worker threads used by ParallelRows.
+ * @param threads amount of workers, 0 restores the default
+ * (std::thread::hardware_concurrency)
+ */
+void SetWorkerThreads(size_t threads) noexcept;
+
+/**
+ * @return number of worker threads used by ParallelRows
+ */
+size_t GetWorkerThreads() noexcept;
+
+/**
+ * turns pinning of worker threads on/off. when on, worker i always runs on
+ * the i-th cpu allowed for the process, so a row chunk that worker i first
+ * touched (and got its pages placed on that cpu's NUMA node) is later
+ * processed from the same node. has no effect on non linux systems
+ * @param pin true to pin workers, false to let the scheduler place them
+ */
+void SetThreadPinning(bool pin) noexcept;
+
+/**
+ * @return true if worker threads are pinned
+ */
+bool GetThreadPinning() noexcept;
+
+/**
+ * runs func over [0, rows) split into GetWorkerThreads() contiguous chunks,
+ * chunk i always given to worker i: [i * rows / n, (i + 1) * rows / n).
+ * the workers are a persistent pool (started on the first parallel call,
+ * restarted only when SetWorkerThreads or SetThreadPinning changed them), and
+ * the caller waits for them. every kernel that touches a matrix's cells
+ * (including the zero fill at construction) goes through this function, so
+ * the pages of a row chunk are first touched and later used by the same
+ * worker.
+ * runs on the calling thread if rows * cols < PARALLEL_MIN_CELLS, if the
+ * pool can't be started, if another call is using the pool, or if called
+ * from inside func. never throws; func must not throw
+ * @param rows number of rows to split
+ * @param cols number of columns in every row (used for the size threshold)
+ * @param func called as func(first_row, last_row) for every non empty chunk
+ */
+void ParallelRows(size_t rows, size_t cols,
+                  const std::function<void(size_t, size_t)>& func) noexcept;
+
+
+#endif //EX5__PARALLEL_H_
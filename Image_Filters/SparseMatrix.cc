@@ -0,0 +1,312 @@
+/**
+ * @file SparseMatrix.cc
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief implementation file for SparseMatrix class
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include "SparseMatrix.h"
+#include <algorithm>
+
+/**
+ * MATRIX_DIMENSION_ERROR_MSG message for MatrixException in case of invalid
+ * dimensions
+ */
+#define MATRIX_DIMENSION_ERROR_MSG "Invalid matrix dimensions.\n"
+
+/**
+ * INDEX_RANGE_ERROR_MSG message for MatrixException in case of accessing
+ * out of matrix range
+ */
+#define INDEX_RANGE_ERROR_MSG "Index out of range.\n"
+
+/**
+ * ALLOC_FAIL_MSG message for MatrixException in case of a allocation failure
+ */
+#define ALLOC_FAIL_MSG "Allocation failed.\n"
+
+
+/**
+ * constructor for an all-zeros sparse matrix in size of rows*cols
+ * @param rows number of rows for the matrix (1 to SPARSE_MAX_DIMENSION)
+ * @param cols number of columns for the matrix (1 to SPARSE_MAX_DIMENSION)
+ * @param format compression format (CSR by default)
+ */
+SparseMatrix::SparseMatrix(size_t rows, size_t cols, SparseFormat format) {
+  if(rows == 0 || cols == 0 || rows > SPARSE_MAX_DIMENSION ||
+     cols > SPARSE_MAX_DIMENSION){
+    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+  }
+  _rows = rows;
+  _cols = cols;
+  _format = format;
+  try{
+    _pointers.assign(GetMajorAmount() + 1, 0);
+  }catch(const std::bad_alloc& err){
+    throw MatrixException(ALLOC_FAIL_MSG);
+  }
+}
+
+/**
+ * constructor compressing a dense Matrix. only non-zero cells are stored
+ * @param dense matrix to compress
+ * @param format compression format (CSR by default)
+ */
+SparseMatrix::SparseMatrix(const Matrix& dense, SparseFormat format)
+    : SparseMatrix(dense.GetRows(), dense.GetCols(), format) {
+  const float *cells = dense.GetMatrix();
+  size_t major = GetMajorAmount();
+  size_t minor = _format == CSR ? _cols : _rows;
+  //counting first so the buffers are allocated exactly once
+  size_t non_zeros = 0;
+  for(size_t i = 0; i < _rows * _cols; ++i){
+    if(cells[i] != 0){
+      non_zeros++;
+    }
+  }
+  try{
+    _values.reserve(non_zeros);
+    _indices.reserve(non_zeros);
+  }catch(const std::bad_alloc& err){
+    throw MatrixException(ALLOC_FAIL_MSG);
+  }
+  for(size_t m = 0; m < major; ++m){
+    for(size_t n = 0; n < minor; ++n){
+      float value = _format == CSR ? cells[m * _cols + n] :
+                    cells[n * _cols + m];
+      if(value != 0){
+        _values.push_back(value);
+        _indices.push_back((SparseIndex)n);
+      }
+    }
+    _pointers[m + 1] = _values.size();
+  }
+}
+
+/**
+ * getter for number of rows
+ * @return number of rows in matrix
+ */
+size_t SparseMatrix::GetRows() const noexcept{
+  return _rows;
+}
+
+/**
+ * getter for number of columns
+ * @return number of columns in matrix
+ */
+size_t SparseMatrix::GetCols() const noexcept{
+  return _cols;
+}
+
+/**
+ * getter for the compression format
+ * @return CSR or CSC
+ */
+SparseFormat SparseMatrix::GetFormat() const noexcept{
+  return _format;
+}
+
+/**
+ * @return amount of stored (non-zero) cells
+ */
+size_t SparseMatrix::GetNonZeros() const noexcept{
+  return _values.size();
+}
+
+/**
+ * decompressing the matrix into a new dense Matrix
+ * @return new Matrix with the same values
+ */
+Matrix SparseMatrix::ToDense() const{
+  Matrix dense(_rows, _cols);
+  float *cells = dense.GetMatrix();
+  for(size_t m = 0; m < GetMajorAmount(); ++m){
+    for(size_t k = _pointers[m]; k < _pointers[m + 1]; ++k){
+      if(_format == CSR){
+        cells[m * _cols + _indices[k]] = _values[k];
+      }else{
+        cells[_indices[k] * _cols + m] = _values[k];
+      }
+    }
+  }
+  return dense;
+}
+
+/**
+ * converts the matrix into the requested compression format in O(nnz)
+ * @param format format to convert to
+ * @return new SparseMatrix in the requested format (copy if already in it)
+ */
+SparseMatrix SparseMatrix::ToFormat(SparseFormat format) const{
+  if(format == _format){
+    return *this;
+  }
+  SparseMatrix converted(_rows, _cols, format);
+  size_t new_major = converted.GetMajorAmount();
+  try{
+    converted._values.resize(_values.size());
+    converted._indices.resize(_indices.size());
+  }catch(const std::bad_alloc& err){
+    throw MatrixException(ALLOC_FAIL_MSG);
+  }
+  //counting sort by minor index: histogram, prefix sum, scatter
+  for(SparseIndex idx : _indices){
+    converted._pointers[idx + 1]++;
+  }
+  for(size_t m = 0; m < new_major; ++m){
+    converted._pointers[m + 1] += converted._pointers[m];
+  }
+  std::vector<size_t> next(converted._pointers.begin(),
+                        converted._pointers.end() - 1);
+  for(size_t m = 0; m < GetMajorAmount(); ++m){
+    for(size_t k = _pointers[m]; k < _pointers[m + 1]; ++k){
+      size_t dest = next[_indices[k]]++;
+      converted._values[dest] = _values[k];
+      converted._indices[dest] = (SparseIndex)m;
+    }
+  }
+  return converted;
+}
+
+/**
+ * returns the value of the matrix in place (i,j), searching the
+ * compressed line in O(log(nnz in line))
+ * @param i row number
+ * @param j column number
+ * @return copy of the value in cell (i,j)
+ */
+float SparseMatrix::operator()(size_t i, size_t j) const{
+  if(i >= _rows || j >= _cols){
+    throw MatrixException(INDEX_RANGE_ERROR_MSG);
+  }
+  size_t major = _format == CSR ? i : j;
+  size_t minor = _format == CSR ? j : i;
+  auto first = _indices.begin() + _pointers[major];
+  auto last = _indices.begin() + _pointers[major + 1];
+  auto found = std::lower_bound(first, last, (SparseIndex)minor);
+  if(found == last || *found != minor){
+    return 0;
+  }
+  return _values[found - _indices.begin()];
+}
+
+/**
+ * sparse-dense multiplication (this on the left). a column vector
+ * operand gives SpMV, any other dense operand gives SpMM
+ * @param dense matrix to multiply with on the right
+ * @return new dense Matrix with the multiplication result
+ */
+Matrix SparseMatrix::operator*(const Matrix& dense) const{
+  if(_cols != dense.GetRows()){
+    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+  }
+  size_t out_cols = dense.GetCols();
+  Matrix result(_rows, out_cols);
+  float *out = result.GetMatrix();
+  const float *in = dense.GetMatrix();
+  if(out_cols == 1){
+    //SpMV: a CSR row is a plain dot product, a CSC column is a scatter
+    for(size_t m = 0; m < GetMajorAmount(); ++m){
+      float sum = 0;
+      for(size_t k = _pointers[m]; k < _pointers[m + 1]; ++k){
+        if(_format == CSR){
+          sum += _values[k] * in[_indices[k]];
+        }else{
+          out[_indices[k]] += _values[k] * in[m];
+        }
+      }
+      if(_format == CSR){
+        out[m] = sum;
+      }
+    }
+    return result;
+  }
+  //SpMM: every stored value scales a whole (contiguous) row of the dense
+  //operand into a row of the result
+  for(size_t m = 0; m < GetMajorAmount(); ++m){
+    for(size_t k = _pointers[m]; k < _pointers[m + 1]; ++k){
+      size_t row = _format == CSR ? m : _indices[k];
+      size_t col = _format == CSR ? _indices[k] : m;
+      float value = _values[k];
+      float *out_row = out + row * out_cols;
+      const float *in_row = in + col * out_cols;
+      for(size_t j = 0; j < out_cols; ++j){
+        out_row[j] += value * in_row[j];
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * dense-sparse multiplication (sparse on the right)
+ * @param dense matrix being multiplied on the left
+ * @param sparse sparse matrix being multiplied on the right
+ * @return new dense Matrix with the multiplication result
+ */
+Matrix operator*(const Matrix& dense, const SparseMatrix& sparse){
+  if(dense.GetCols() != sparse._rows){
+    throw MatrixException(MATRIX_DIMENSION_ERROR_MSG);
+  }
+  size_t rows = dense.GetRows();
+  size_t inner = dense.GetCols();
+  size_t out_cols = sparse._cols;
+  Matrix result(rows, out_cols);
+  float *out = result.GetMatrix();
+  const float *in = dense.GetMatrix();
+  for(size_t i = 0; i < rows; ++i){
+    const float *in_row = in + i * inner;
+    float *out_row = out + i * out_cols;
+    if(sparse._format == CSC){
+      //every result cell is a dot product with one compressed column
+      for(size_t j = 0; j < out_cols; ++j){
+        float sum = 0;
+        for(size_t k = sparse._pointers[j]; k < sparse._pointers[j + 1]; ++k){
+          sum += in_row[sparse._indices[k]] * sparse._values[k];
+        }
+        out_row[j] = sum;
+      }
+    }else{
+      //every non-zero dense cell scatters one compressed row
+      for(size_t r = 0; r < inner; ++r){
+        float scale = in_row[r];
+        if(scale == 0){
+          continue;
+        }
+        for(size_t k = sparse._pointers[r]; k < sparse._pointers[r + 1]; ++k){
+          out_row[sparse._indices[k]] += scale * sparse._values[k];
+        }
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * checks if two sparse matrices hold the same values (format independent)
+ * @param other matrix to compare to
+ * @return true in case of equality, false otherwise
+ */
+bool SparseMatrix::operator==(const SparseMatrix& other) const{
+  if(_rows != other._rows || _cols != other._cols){
+    return false;
+  }
+  if(_format != other._format){
+    return *this == other.ToFormat(_format);
+  }
+  return _pointers == other._pointers && _indices == other._indices &&
+         _values == other._values;
+}
+
+/**
+ * checks if two sparse matrices are not equal
+ * @param other matrix to compare to
+ * @return true in case matrices are not equal, false otherwise
+ */
+bool SparseMatrix::operator!=(const SparseMatrix& other) const{
+  return !(*this == other);
+}
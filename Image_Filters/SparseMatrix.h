@@ -0,0 +1,150 @@
+/**
+ * @file SparseMatrix.h
+ * @author  Eran Turgeman <eran.turgeman@mail.huji.ac.il>
+ *
+ * @brief h file for SparseMatrix class (CSR / CSC compressed storage)
+ *
+ * @section LICENSE
+ * This program is private and was made for the 2020 67315 course
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef EX5__SPARSE_MATRIX_H_
+#define EX5__SPARSE_MATRIX_H_
+#include "Matrix.h"
+
+/**
+ * SparseFormat compression order of a SparseMatrix:
+ * CSR- rows are compressed (non-zeros stored row after row)
+ * CSC- columns are compressed (non-zeros stored column after column)
+ */
+enum SparseFormat {CSR, CSC};
+
+/**
+ * SparseIndex type of the stored minor (column in CSR, row in CSC) index of
+ * every non-zero. 32 bits keep the index memory at 4 bytes per non-zero;
+ * the line pointers are size_t, so nnz itself isn't limited
+ */
+typedef uint32_t SparseIndex;
+
+/**
+ * SPARSE_MAX_DIMENSION largest amount of rows or columns of a SparseMatrix
+ * (every index must fit in a SparseIndex, in both formats)
+ */
+#define SPARSE_MAX_DIMENSION ((size_t)UINT32_MAX + 1)
+
+class SparseMatrix
+{
+  size_t _rows;
+  size_t _cols;
+  SparseFormat _format;
+  std::vector<float> _values;
+  std::vector<SparseIndex> _indices;
+  std::vector<size_t> _pointers;
+
+  /**
+   * PRIVATE FUNCTION: number of compressed lines (rows in CSR, columns in CSC)
+   * @return _rows for CSR, _cols for CSC
+   */
+  size_t GetMajorAmount() const noexcept{
+    return _format == CSR ? _rows : _cols;
+  }
+
+ public:
+
+  /**
+   * constructor for an all-zeros sparse matrix in size of rows*cols
+   * @param rows number of rows for the matrix (1 to SPARSE_MAX_DIMENSION)
+   * @param cols number of columns for the matrix (1 to SPARSE_MAX_DIMENSION)
+   * @param format compression format (CSR by default)
+   */
+  SparseMatrix(size_t rows, size_t cols, SparseFormat format = CSR);
+
+  /**
+   * constructor compressing a dense Matrix. only non-zero cells are stored
+   * @param dense matrix to compress
+   * @param format compression format (CSR by default)
+   */
+  explicit SparseMatrix(const Matrix& dense, SparseFormat format = CSR);
+
+  /**
+   * getter for number of rows
+   * @return number of rows in matrix
+   */
+  size_t GetRows() const noexcept;
+
+  /**
+   * getter for number of columns
+   * @return number of columns in matrix
+   */
+  size_t GetCols() const noexcept;
+
+  /**
+   * getter for the compression format
+   * @return CSR or CSC
+   */
+  SparseFormat GetFormat() const noexcept;
+
+  /**
+   * @return amount of stored (non-zero) cells
+   */
+  size_t GetNonZeros() const noexcept;
+
+  /**
+   * decompressing the matrix into a new dense Matrix
+   * @return new Matrix with the same values
+   */
+  Matrix ToDense() const;
+
+  /**
+   * converts the matrix into the requested compression format in O(nnz)
+   * @param format format to convert to
+   * @return new SparseMatrix in the requested format (copy if already in it)
+   */
+  SparseMatrix ToFormat(SparseFormat format) const;
+
+  /**
+   * returns the value of the matrix in place (i,j), searching the
+   * compressed line in O(log(nnz in line))
+   * @param i row number
+   * @param j column number
+   * @return copy of the value in cell (i,j)
+   */
+  float operator()(size_t i, size_t j) const;
+
+  /**
+   * sparse-dense multiplication (this on the left). a column vector
+   * operand gives SpMV, any other dense operand gives SpMM
+   * @param dense matrix to multiply with on the right
+   * @return new dense Matrix with the multiplication result
+   */
+  Matrix operator*(const Matrix& dense) const;
+
+  /**
+   * dense-sparse multiplication (sparse on the right)
+   * @param dense matrix being multiplied on the left
+   * @param sparse sparse matrix being multiplied on the right
+   * @return new dense Matrix with the multiplication result
+   */
+  friend Matrix operator*(const Matrix& dense, const SparseMatrix& sparse);
+
+  /**
+   * checks if two sparse matrices hold the same values (format independent)
+   * @param other matrix to compare to
+   * @return true in case of equality, false otherwise
+   */
+  bool operator==(const SparseMatrix& other) const;
+
+  /**
+   * checks if two sparse matrices are not equal
+   * @param other matrix to compare to
+   * @return true in case matrices are not equal, false otherwise
+   */
+  bool operator!=(const SparseMatrix& other) const;
+};
+
+
+#endif //EX5__SPARSE_MATRIX_H_
@@ -0,0 +1,360 @@
+
+#include "vl_vector.h"
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * CONCURRENT_MAX_SEGMENTS amount of segments of a ConcurrentVLVector (the
+ * static one included). segment k > 0 holds StaticCapacity * 2^(k-1)
+ * elements
+ */
+#define CONCURRENT_MAX_SEGMENTS 48
+
+/**
+ * UNPUBLISHED_ERROR_MSG error message text in case of reading an element
+ * that wasn't published yet
+ */
+#define UNPUBLISHED_ERROR_MSG "Element not published yet!"
+
+#ifndef EX6__CONCURRENT_VL_VECTOR_H_
+#define EX6__CONCURRENT_VL_VECTOR_H_
+
+/**
+ * concurrent append only sibling of VLVector: the first StaticCapacity
+ * elements are kept in the object itself, the rest in segments that double
+ * in size and are never moved or freed while the vector lives, so
+ * references to elements stay valid.
+ * PushBack/EmplaceBack may be called from any number of threads at once and
+ * never wait for each other: one fetch_add for the index, and at most one
+ * compare_exchange to install a new segment. a segment is normally
+ * allocated ahead of time (by the append that fills half of the previous
+ * segment); an append reaching it first allocates its own and the loser of
+ * the compare_exchange frees its copy. an element is published once it is
+ * fully constructed: IsPublished(), At(), operator[] and
+ * ForEach() may run concurrently with appends and only see published
+ * elements.
+ * Clear() and the destructor must not run concurrently with anything
+ * @tparam T elements type
+ * @tparam StaticCapacity amount of elements stored without allocating (> 0)
+ */
+template<typename T, size_t StaticCapacity = DEFAULT_STATIC_CAPACITY>
+class ConcurrentVLVector {
+  static_assert(StaticCapacity > 0, "StaticCapacity must be positive");
+
+  /**
+   * Cell one element and the flag publishing it
+   */
+  struct Cell {
+    alignas(T) unsigned char storage[sizeof(T)];
+    std::atomic<bool> published{false};
+
+    /**
+     * @return the element in the cell (must be constructed)
+     */
+    T *Get() noexcept { return std::launder(reinterpret_cast<T *>(storage)); }
+
+    /**
+     * @return the element in the cell (must be constructed)
+     */
+    const T *Get() const noexcept {
+      return std::launder(reinterpret_cast<const T *>(storage));
+    }
+  };
+
+  //amount of indices handed out (published or still being constructed)
+  std::atomic<size_t> reserved_;
+  //segments_[0] is static_cells_, the others are allocated on demand
+  std::atomic<Cell *> segments_[CONCURRENT_MAX_SEGMENTS];
+  Cell static_cells_[StaticCapacity];
+
+  /**
+   * @param x positive number
+   * @return floor(log2(x))
+   */
+  static size_t FloorLog2(size_t x) noexcept {
+#if defined(__GNUC__)
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(x);
+#else
+    size_t log = 0;
+    while (x >>= 1) {
+      ++log;
+    }
+    return log;
+#endif
+  }
+
+  /**
+   * @param segment segment number
+   * @return amount of cells in the segment
+   */
+  static constexpr size_t SegmentSize(size_t segment) noexcept {
+    return segment == 0 ? StaticCapacity :
+           StaticCapacity << (segment - 1);
+  }
+
+  /**
+   * finds the segment of an index
+   * @param index element index
+   * @param segment set to the segment number
+   * @param offset set to the index inside the segment
+   */
+  static void Locate(size_t index, size_t &segment, size_t &offset) noexcept {
+    if (index < StaticCapacity) {
+      segment = 0;
+      offset = index;
+      return;
+    }
+    segment = FloorLog2(index / StaticCapacity) + 1;
+    offset = index - SegmentSize(segment);
+  }
+
+  /**
+   * installs cells as the segment unless another thread installed one first,
+   * in which case cells are freed
+   * @param segment segment number (> 0)
+   * @param cells newly allocated cells of the segment
+   * @return the installed segment's cells
+   */
+  Cell *InstallSegment(size_t segment, Cell *cells) noexcept {
+    Cell *installed = nullptr;
+    if (segments_[segment].compare_exchange_strong(installed, cells,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+      return cells;
+    }
+    delete[] cells;
+    return installed;
+  }
+
+  /**
+   * returns the segment, allocating it if no thread installed it yet
+   * @param segment segment number (> 0)
+   * @return the segment's cells
+   * @throw std::bad_alloc if the segment is missing and allocating it failed
+   */
+  Cell *GetOrCreateSegment(size_t segment) {
+    Cell *cells = segments_[segment].load(std::memory_order_acquire);
+    if (cells != nullptr) {
+      return cells;
+    }
+    return InstallSegment(segment, new Cell[SegmentSize(segment)]);
+  }
+
+  /**
+   * allocates the segment unless it exists. a failed allocation is left to
+   * GetOrCreateSegment
+   * @param segment segment number (> 0)
+   */
+  void AllocateAhead(size_t segment) noexcept {
+    if (segment >= CONCURRENT_MAX_SEGMENTS ||
+        segments_[segment].load(std::memory_order_relaxed) != nullptr) {
+      return;
+    }
+    Cell *cells = new(std::nothrow) Cell[SegmentSize(segment)];
+    if (cells != nullptr) {
+      InstallSegment(segment, cells);
+    }
+  }
+
+  /**
+   * @param index element index (< Size())
+   * @return its cell, nullptr if its segment isn't allocated yet
+   */
+  const Cell *FindCell(size_t index) const noexcept {
+    size_t segment, offset;
+    Locate(index, segment, offset);
+    if (segment >= CONCURRENT_MAX_SEGMENTS) {
+      return nullptr;
+    }
+    const Cell *cells = segments_[segment].load(std::memory_order_acquire);
+    return cells == nullptr ? nullptr : cells + offset;
+  }
+
+  /**
+   * destroys all published elements and frees the segments (no concurrent
+   * operations)
+   */
+  void DestroyAll() noexcept;
+
+ public:
+  /**
+   * Default constructor
+   */
+  ConcurrentVLVector() noexcept : reserved_(0) {
+    segments_[0].store(static_cells_, std::memory_order_relaxed);
+    for (size_t i = 1; i < CONCURRENT_MAX_SEGMENTS; ++i) {
+      segments_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  //elements are never moved: no copy or move
+  ConcurrentVLVector(const ConcurrentVLVector &) = delete;
+  ConcurrentVLVector &operator=(const ConcurrentVLVector &) = delete;
+
+  /**
+   * Destructor- destroys the published elements and frees the segments
+   */
+  ~ConcurrentVLVector() noexcept { DestroyAll(); }
+
+  /**
+   * constructs new element from args at the next free index and publishes
+   * it. thread safe and wait free. if this throws (T's constructor or the
+   * segment allocation) the index stays unpublished for good
+   * @param args arguments for T's constructor
+   * @return index of the new element
+   * @throw std::length_error if the vector is full
+   */
+  template<typename... Args>
+  size_t EmplaceBack(Args &&... args);
+
+  /**
+   * adds a copy of new_elem at the end (see EmplaceBack)
+   * @return index of the new element
+   */
+  size_t PushBack(const T &new_elem) { return EmplaceBack(new_elem); }
+
+  /**
+   * moves new_elem in at the end (see EmplaceBack)
+   * @return index of the new element
+   */
+  size_t PushBack(T &&new_elem) { return EmplaceBack(std::move(new_elem)); }
+
+  /**
+   * @return amount of indices handed out so far. elements below it may still
+   * be under construction (see IsPublished)
+   */
+  size_t Size() const noexcept {
+    return reserved_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @return true if no index was handed out
+   */
+  bool Empty() const noexcept { return Size() == 0; }
+
+  /**
+   * @param index element index
+   * @return true if the element is constructed and visible to this thread
+   */
+  bool IsPublished(size_t index) const noexcept {
+    if (index >= Size()) {
+      return false;
+    }
+    const Cell *cell = FindCell(index);
+    return cell != nullptr && cell->published.load(std::memory_order_acquire);
+  }
+
+  /**
+   * returns a published element (no check, see At)
+   * @param index index of a published element
+   * @return const reference to the element
+   */
+  const T &operator[](size_t index) const noexcept {
+    return *FindCell(index)->Get();
+  }
+
+  /**
+   * returns a published element
+   * @param index element index
+   * @return const reference to the element
+   * @throw std::out_of_range if index >= Size() or the element isn't
+   * published yet
+   */
+  const T &At(size_t index) const {
+    if (index >= Size()) {
+      throw std::out_of_range(INDEX_ERROR_MSG);
+    }
+    if (!IsPublished(index)) {
+      throw std::out_of_range(UNPUBLISHED_ERROR_MSG);
+    }
+    return (*this)[index];
+  }
+
+  /**
+   * calls func(index, element) for every element published when it is
+   * reached, in index order (elements still under construction are skipped)
+   * @param func called as func(size_t, const T &)
+   */
+  template<typename Func>
+  void ForEach(Func func) const;
+
+  /**
+   * destroys all elements and frees the segments (not thread safe: no
+   * concurrent operations)
+   */
+  void Clear() noexcept;
+};
+
+template<typename T, size_t StaticCapacity>
+template<typename... Args>
+size_t ConcurrentVLVector<T, StaticCapacity>::EmplaceBack(Args &&... args) {
+  size_t index = reserved_.fetch_add(1, std::memory_order_relaxed);
+  size_t segment, offset;
+  Locate(index, segment, offset);
+  if (segment >= CONCURRENT_MAX_SEGMENTS) {
+    throw std::length_error(MAX_SIZE_ERROR_MSG);
+  }
+  Cell *cells = segment == 0 ? static_cells_ : GetOrCreateSegment(segment);
+  if (segment != 0 && offset == SegmentSize(segment) / 2) {
+    //half way through this segment: the next one is allocated before any
+    //thread needs it
+    AllocateAhead(segment + 1);
+  }
+  Cell &cell = cells[offset];
+  ::new(static_cast<void *>(cell.storage)) T(std::forward<Args>(args)...);
+  cell.published.store(true, std::memory_order_release);
+  return index;
+}
+
+template<typename T, size_t StaticCapacity>
+template<typename Func>
+void ConcurrentVLVector<T, StaticCapacity>::ForEach(Func func) const {
+  size_t size = Size();
+  size_t index = 0;
+  for (size_t segment = 0; segment < CONCURRENT_MAX_SEGMENTS &&
+      index < size; ++segment) {
+    const Cell *cells = segments_[segment].load(std::memory_order_acquire);
+    size_t segment_size = SegmentSize(segment);
+    if (cells == nullptr) {
+      index += segment_size;
+      continue;
+    }
+    for (size_t i = 0; i < segment_size && index < size; ++i, ++index) {
+      if (cells[i].published.load(std::memory_order_acquire)) {
+        func(index, *cells[i].Get());
+      }
+    }
+  }
+}
+
+template<typename T, size_t StaticCapacity>
+void ConcurrentVLVector<T, StaticCapacity>::DestroyAll() noexcept {
+  for (size_t segment = 0; segment < CONCURRENT_MAX_SEGMENTS; ++segment) {
+    Cell *cells = segments_[segment].load(std::memory_order_acquire);
+    if (cells == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < SegmentSize(segment); ++i) {
+      if (cells[i].published.load(std::memory_order_relaxed)) {
+        cells[i].Get()->~T();
+        cells[i].published.store(false, std::memory_order_relaxed);
+      }
+    }
+    if (segment != 0) {
+      delete[] cells;
+      segments_[segment].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+}
+
+template<typename T, size_t StaticCapacity>
+void ConcurrentVLVector<T, StaticCapacity>::Clear() noexcept {
+  DestroyAll();
+  reserved_.store(0, std::memory_order_release);
+}
+
+#endif //EX6__CONCURRENT_VL_VECTOR_H_
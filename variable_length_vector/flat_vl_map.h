@@ -0,0 +1,614 @@
+
+#include "vl_vector.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * FLAT_BRANCHLESS_MAX_SIZE flat containers of up to this many elements are
+ * searched with the branch free binary search, bigger ones with
+ * std::lower_bound
+ */
+#define FLAT_BRANCHLESS_MAX_SIZE 64
+
+/**
+ * KEY_ERROR_MSG error message text in case of a missing key
+ */
+#define KEY_ERROR_MSG "Key not found!"
+
+#ifndef EX6__FLAT_VL_MAP_H_
+#define EX6__FLAT_VL_MAP_H_
+
+/**
+ * FlatSetKey key of a FlatVLSet element: the element itself
+ */
+struct FlatSetKey {
+  /**
+   * @param elem set element
+   * @return elem
+   */
+  template<typename Elem>
+  static const Elem &Get(const Elem &elem) noexcept { return elem; }
+};
+
+/**
+ * FlatMapKey key of a FlatVLMap element: pair.first
+ */
+struct FlatMapKey {
+  /**
+   * @param elem map element
+   * @return elem.first
+   */
+  template<typename Pair>
+  static const typename Pair::first_type &Get(const Pair &elem) noexcept {
+    return elem.first;
+  }
+};
+
+/**
+ * IsTransparent true if Compare::is_transparent exists (e.g. std::less<>):
+ * lookups then accept any type Compare can compare with the key
+ */
+template<typename Compare, typename = void>
+struct IsTransparent : std::false_type {};
+
+template<typename Compare>
+struct IsTransparent<Compare, std::void_t<typename Compare::is_transparent>>
+    : std::true_type {};
+
+/**
+ * SortedVLVector common part of FlatVLSet and FlatVLMap: elements with
+ * unique keys kept sorted in a VLVector, so up to StaticCapacity of them
+ * need no allocation and a lookup is a binary search over one array
+ * @tparam Elem elements type
+ * @tparam Key keys type
+ * @tparam KeyOf gives the key of an element (FlatSetKey, FlatMapKey)
+ * @tparam Compare strict weak order of the keys
+ * @tparam StaticCapacity amount of elements stored without allocating
+ */
+template<typename Elem, typename Key, typename KeyOf, typename Compare,
+    size_t StaticCapacity>
+class SortedVLVector {
+ protected:
+  VLVector<Elem, StaticCapacity> vec_;
+  Compare comp_;
+
+  /**
+   * enables a template lookup for K only if it is the key type or Compare
+   * is transparent
+   */
+  template<typename K>
+  using EnableLookup = typename std::enable_if<
+      std::is_same<K, Key>::value || IsTransparent<Compare>::value>::type;
+
+  /**
+   * @param comp key order
+   */
+  explicit SortedVLVector(const Compare &comp) : comp_(comp) {}
+
+  /**
+   * @param key key to look for
+   * @return index of the first element whose key isn't less than key
+   */
+  template<typename K>
+  size_t LowerBoundIndex(const K &key) const;
+
+  /**
+   * @param key key to look for
+   * @return index of the first element whose key is greater than key
+   */
+  template<typename K>
+  size_t UpperBoundIndex(const K &key) const;
+
+  /**
+   * @param index result of LowerBoundIndex(key)
+   * @param key the key looked for
+   * @return true if the element at index has that key
+   */
+  template<typename K>
+  bool Matches(size_t index, const K &key) const {
+    return index < vec_.Size() &&
+        !comp_(key, KeyOf::Get(vec_.Data()[index]));
+  }
+
+  /**
+   * constructs an element at the position of key unless key is present
+   * @param key key of the new element
+   * @param args arguments for Elem's constructor
+   * @return index of the element with that key and true if it was inserted
+   */
+  template<typename... Args>
+  std::pair<size_t, bool> EmplaceUnique(const Key &key, Args &&... args) {
+    size_t index = LowerBoundIndex(key);
+    if (Matches(index, key)) {
+      return {index, false};
+    }
+    vec_.Emplace(vec_.cbegin() + index, std::forward<Args>(args)...);
+    return {index, true};
+  }
+
+ public:
+  /**
+   * const iterator over the elements, in key order
+   */
+  typedef typename VLVector<Elem, StaticCapacity>::const_iterator
+      const_iterator;
+
+  /**
+   * @return const iterator to the element with the smallest key
+   */
+  const_iterator begin() const noexcept { return vec_.cbegin(); }
+
+  /**
+   * @return const iterator to one past the last element
+   */
+  const_iterator end() const noexcept { return vec_.cend(); }
+
+  /**
+   * @return const iterator to the element with the smallest key
+   */
+  const_iterator cbegin() const noexcept { return vec_.cbegin(); }
+
+  /**
+   * @return const iterator to one past the last element
+   */
+  const_iterator cend() const noexcept { return vec_.cend(); }
+
+  /**
+   * @return amount of elements
+   */
+  size_t Size() const noexcept { return vec_.Size(); }
+
+  /**
+   * @return true if there are no elements
+   */
+  bool Empty() const noexcept { return vec_.Empty(); }
+
+  /**
+   * removes all elements
+   */
+  void Clear() noexcept { vec_.Clear(); }
+
+  /**
+   * @param key key to look for
+   * @return const iterator to the element with that key, end() if none
+   */
+  const_iterator Find(const Key &key) const { return Find<Key>(key); }
+
+  /**
+   * heterogeneous Find (Compare must be transparent)
+   * @param key value comparable with the keys
+   * @return const iterator to the element with that key, end() if none
+   */
+  template<typename K, typename = EnableLookup<K>>
+  const_iterator Find(const K &key) const {
+    size_t index = LowerBoundIndex(key);
+    return Matches(index, key) ? begin() + index : end();
+  }
+
+  /**
+   * @param key key to look for
+   * @return true if an element has that key
+   */
+  bool Contains(const Key &key) const { return Contains<Key>(key); }
+
+  /**
+   * heterogeneous Contains (Compare must be transparent)
+   * @param key value comparable with the keys
+   * @return true if an element has that key
+   */
+  template<typename K, typename = EnableLookup<K>>
+  bool Contains(const K &key) const {
+    return Matches(LowerBoundIndex(key), key);
+  }
+
+  /**
+   * @param key key to count
+   * @return 1 if an element has that key, 0 otherwise
+   */
+  size_t Count(const Key &key) const { return Contains(key) ? 1 : 0; }
+
+  /**
+   * @param key key to look for
+   * @return const iterator to the first element whose key isn't less than
+   * key
+   */
+  const_iterator LowerBound(const Key &key) const {
+    return begin() + LowerBoundIndex(key);
+  }
+
+  /**
+   * @param key key to look for
+   * @return const iterator to the first element whose key is greater than
+   * key
+   */
+  const_iterator UpperBound(const Key &key) const {
+    return begin() + UpperBoundIndex(key);
+  }
+
+  /**
+   * removes the element with the given key
+   * @param key key to remove
+   * @return 1 if an element was removed, 0 otherwise
+   */
+  size_t Erase(const Key &key);
+
+  /**
+   * removes the element position points to
+   * @param position valid dereferenceable iterator
+   * @return iterator to the element after the removed one
+   */
+  const_iterator Erase(const_iterator position) {
+    return vec_.Erase(position);
+  }
+
+  /**
+   * inserts the elements of [first, last) whose keys aren't present yet
+   * (the first of equal keys wins, like repeated Insert) with one sort of the
+   * new elements and one merge instead of a shifting insert for each.
+   * if copying an element in (or allocating) throws the container is left
+   * unchanged, if a comparison or a move throws while sorting it is cleared
+   * @param first iterator to the first element to insert
+   * @param last iterator to one past the last element to insert
+   */
+  template<typename InputIterator>
+  void Insert(InputIterator first, InputIterator last);
+
+  /**
+   * @param other container to compare with
+   * @return true if both hold the same elements
+   */
+  bool operator==(const SortedVLVector &other) const {
+    return vec_ == other.vec_;
+  }
+
+  /**
+   * @param other container to compare with
+   * @return true if the elements differ
+   */
+  bool operator!=(const SortedVLVector &other) const {
+    return !(*this == other);
+  }
+};
+
+template<typename Elem, typename Key, typename KeyOf, typename Compare,
+    size_t StaticCapacity>
+template<typename K>
+size_t SortedVLVector<Elem, Key, KeyOf, Compare, StaticCapacity>::
+LowerBoundIndex(const K &key) const {
+  const Elem *first = vec_.Data();
+  size_t size = vec_.Size();
+  if (size > FLAT_BRANCHLESS_MAX_SIZE) {
+    return std::lower_bound(first, first + size, key,
+                            [this](const Elem &elem, const K &k) {
+                              return comp_(KeyOf::Get(elem), k);
+                            }) - first;
+  }
+  if (size == 0) {
+    return 0;
+  }
+  //halves the range with a conditional move instead of a branch
+  const Elem *base = first;
+  while (size > 1) {
+    size_t half = size / 2;
+    base = comp_(KeyOf::Get(base[half]), key) ? base + half : base;
+    size -= half;
+  }
+  return (base - first) + (comp_(KeyOf::Get(*base), key) ? 1 : 0);
+}
+
+template<typename Elem, typename Key, typename KeyOf, typename Compare,
+    size_t StaticCapacity>
+template<typename K>
+size_t SortedVLVector<Elem, Key, KeyOf, Compare, StaticCapacity>::
+UpperBoundIndex(const K &key) const {
+  size_t index = LowerBoundIndex(key);
+  //keys are unique: at most one element is equivalent to key
+  return Matches(index, key) ? index + 1 : index;
+}
+
+template<typename Elem, typename Key, typename KeyOf, typename Compare,
+    size_t StaticCapacity>
+size_t SortedVLVector<Elem, Key, KeyOf, Compare, StaticCapacity>::Erase(
+    const Key &key) {
+  size_t index = LowerBoundIndex(key);
+  if (!Matches(index, key)) {
+    return 0;
+  }
+  vec_.Erase(vec_.cbegin() + index);
+  return 1;
+}
+
+template<typename Elem, typename Key, typename KeyOf, typename Compare,
+    size_t StaticCapacity>
+template<typename InputIterator>
+void SortedVLVector<Elem, Key, KeyOf, Compare, StaticCapacity>::Insert(
+    InputIterator first, InputIterator last) {
+  size_t old_size = vec_.Size();
+  try {
+    for (; first != last; ++first) {
+      vec_.EmplaceBack(*first);
+    }
+  } catch (...) {
+    //the unsorted tail is dropped: the container is left as it was
+    vec_.Erase(vec_.cbegin() + old_size, vec_.cend());
+    throw;
+  }
+  auto less = [this](const Elem &lhs, const Elem &rhs) {
+    return comp_(KeyOf::Get(lhs), KeyOf::Get(rhs));
+  };
+  auto equivalent = [this](const Elem &lhs, const Elem &rhs) {
+    return !comp_(KeyOf::Get(lhs), KeyOf::Get(rhs)) &&
+        !comp_(KeyOf::Get(rhs), KeyOf::Get(lhs));
+  };
+  try {
+    //stable: among equal keys the old element, then the first new one stay
+    auto mid = vec_.begin() + old_size;
+    std::stable_sort(mid, vec_.end(), less);
+    std::inplace_merge(vec_.begin(), mid, vec_.end(), less);
+    vec_.Erase(std::unique(vec_.begin(), vec_.end(), equivalent),
+               vec_.end());
+  } catch (...) {
+    //a half merged array isn't sorted
+    vec_.Clear();
+    throw;
+  }
+}
+
+/**
+ * flat sorted set on a VLVector: a replacement for std::set for small
+ * collections (no node allocations, one contiguous array, the first
+ * StaticCapacity elements inside the object). iterators are invalidated by
+ * every insertion and removal
+ * @tparam Key keys type
+ * @tparam StaticCapacity amount of keys stored without allocating
+ * @tparam Compare strict weak order of the keys (std::less<> enables
+ * heterogeneous lookup)
+ */
+template<typename Key, size_t StaticCapacity = DEFAULT_STATIC_CAPACITY,
+    typename Compare = std::less<Key>>
+class FlatVLSet
+    : public SortedVLVector<Key, Key, FlatSetKey, Compare, StaticCapacity> {
+  typedef SortedVLVector<Key, Key, FlatSetKey, Compare, StaticCapacity> Base;
+
+ public:
+  using typename Base::const_iterator;
+  using Base::Insert;
+
+  /**
+   * Constructor for an empty set
+   * @param comp key order
+   */
+  explicit FlatVLSet(const Compare &comp = Compare()) : Base(comp) {}
+
+  /**
+   * Constructor for a set of the keys in [first, last)
+   * @param first iterator to the first key
+   * @param last iterator to one past the last key
+   * @param comp key order
+   */
+  template<typename InputIterator>
+  FlatVLSet(InputIterator first, InputIterator last,
+            const Compare &comp = Compare()) : Base(comp) {
+    Insert(first, last);
+  }
+
+  /**
+   * Constructor for a set of the given keys
+   * @param keys keys to insert
+   * @param comp key order
+   */
+  FlatVLSet(std::initializer_list<Key> keys, const Compare &comp = Compare())
+      : Base(comp) {
+    Insert(keys.begin(), keys.end());
+  }
+
+  /**
+   * inserts key unless it is present
+   * @param key key to insert
+   * @return iterator to the element with that key and true if it was
+   * inserted
+   */
+  std::pair<const_iterator, bool> Insert(const Key &key) {
+    std::pair<size_t, bool> result = this->EmplaceUnique(key, key);
+    return {this->begin() + result.first, result.second};
+  }
+
+  /**
+   * moves key in unless it is present
+   * @param key key to insert
+   * @return iterator to the element with that key and true if it was
+   * inserted
+   */
+  std::pair<const_iterator, bool> Insert(Key &&key) {
+    std::pair<size_t, bool> result = this->EmplaceUnique(key, std::move(key));
+    return {this->begin() + result.first, result.second};
+  }
+};
+
+/**
+ * flat sorted map on a VLVector of std::pair<Key, Value>: a replacement for
+ * std::map for small collections (see FlatVLSet). the key of an element
+ * must not be changed through an iterator
+ * @tparam Key keys type
+ * @tparam Value mapped values type
+ * @tparam StaticCapacity amount of elements stored without allocating
+ * @tparam Compare strict weak order of the keys (std::less<> enables
+ * heterogeneous lookup)
+ */
+template<typename Key, typename Value,
+    size_t StaticCapacity = DEFAULT_STATIC_CAPACITY,
+    typename Compare = std::less<Key>>
+class FlatVLMap
+    : public SortedVLVector<std::pair<Key, Value>, Key, FlatMapKey, Compare,
+                            StaticCapacity> {
+  typedef SortedVLVector<std::pair<Key, Value>, Key, FlatMapKey, Compare,
+                         StaticCapacity> Base;
+
+ public:
+  /**
+   * element type
+   */
+  typedef std::pair<Key, Value> value_type;
+  /**
+   * iterator over the elements, in key order
+   */
+  typedef typename VLVector<value_type, StaticCapacity>::iterator iterator;
+  using typename Base::const_iterator;
+  using Base::begin;
+  using Base::end;
+  using Base::Find;
+  using Base::Insert;
+
+  /**
+   * Constructor for an empty map
+   * @param comp key order
+   */
+  explicit FlatVLMap(const Compare &comp = Compare()) : Base(comp) {}
+
+  /**
+   * Constructor for a map of the elements in [first, last) (the first of
+   * equal keys wins)
+   * @param first iterator to the first element
+   * @param last iterator to one past the last element
+   * @param comp key order
+   */
+  template<typename InputIterator>
+  FlatVLMap(InputIterator first, InputIterator last,
+            const Compare &comp = Compare()) : Base(comp) {
+    Insert(first, last);
+  }
+
+  /**
+   * Constructor for a map of the given elements (the first of equal keys
+   * wins)
+   * @param elems elements to insert
+   * @param comp key order
+   */
+  FlatVLMap(std::initializer_list<value_type> elems,
+            const Compare &comp = Compare()) : Base(comp) {
+    Insert(elems.begin(), elems.end());
+  }
+
+  /**
+   * @return iterator to the element with the smallest key
+   */
+  iterator begin() noexcept { return this->vec_.begin(); }
+
+  /**
+   * @return iterator to one past the last element
+   */
+  iterator end() noexcept { return this->vec_.end(); }
+
+  /**
+   * @param key key to look for
+   * @return iterator to the element with that key, end() if none
+   */
+  iterator Find(const Key &key) { return Find<Key>(key); }
+
+  /**
+   * heterogeneous Find (Compare must be transparent)
+   * @param key value comparable with the keys
+   * @return iterator to the element with that key, end() if none
+   */
+  template<typename K, typename = typename Base::template EnableLookup<K>>
+  iterator Find(const K &key) {
+    size_t index = this->LowerBoundIndex(key);
+    return this->Matches(index, key) ? begin() + index : end();
+  }
+
+  /**
+   * inserts elem unless its key is present
+   * @param elem element to insert
+   * @return iterator to the element with that key and true if it was
+   * inserted
+   */
+  std::pair<iterator, bool> Insert(const value_type &elem) {
+    std::pair<size_t, bool> result = this->EmplaceUnique(elem.first, elem);
+    return {begin() + result.first, result.second};
+  }
+
+  /**
+   * moves elem in unless its key is present
+   * @param elem element to insert
+   * @return iterator to the element with that key and true if it was
+   * inserted
+   */
+  std::pair<iterator, bool> Insert(value_type &&elem) {
+    std::pair<size_t, bool> result =
+        this->EmplaceUnique(elem.first, std::move(elem));
+    return {begin() + result.first, result.second};
+  }
+
+  /**
+   * constructs the value from args if key is not present (args are left
+   * untouched otherwise)
+   * @param key key of the element
+   * @param args arguments for Value's constructor
+   * @return iterator to the element with that key and true if it was
+   * inserted
+   */
+  template<typename... Args>
+  std::pair<iterator, bool> TryEmplace(const Key &key, Args &&... args) {
+    std::pair<size_t, bool> result = this->EmplaceUnique(
+        key, std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+    return {begin() + result.first, result.second};
+  }
+
+  /**
+   * sets the value of key, inserting it if it is not present
+   * @param key key of the element
+   * @param value value to set
+   * @return iterator to the element and true if it was inserted
+   */
+  template<typename V>
+  std::pair<iterator, bool> InsertOrAssign(const Key &key, V &&value) {
+    std::pair<iterator, bool> result = TryEmplace(key, std::forward<V>(value));
+    if (!result.second) {
+      result.first->second = std::forward<V>(value);
+    }
+    return result;
+  }
+
+  /**
+   * returns the value of key, inserting a value initialized one if key is
+   * not present
+   * @param key key of the element
+   * @return reference to the value
+   */
+  Value &operator[](const Key &key) { return TryEmplace(key).first->second; }
+
+  /**
+   * @param key key of the element
+   * @return reference to the value of key
+   * @throw std::out_of_range if key is not present
+   */
+  Value &At(const Key &key) {
+    iterator it = Find(key);
+    if (it == end()) {
+      throw std::out_of_range(KEY_ERROR_MSG);
+    }
+    return it->second;
+  }
+
+  /**
+   * @param key key of the element
+   * @return const reference to the value of key
+   * @throw std::out_of_range if key is not present
+   */
+  const Value &At(const Key &key) const {
+    const_iterator it = Find(key);
+    if (it == end()) {
+      throw std::out_of_range(KEY_ERROR_MSG);
+    }
+    return it->second;
+  }
+};
+
+#endif //EX6__FLAT_VL_MAP_H_
@@ -1,7 +1,22 @@
 
 #include <cmath>
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iterator>
+#include <memory>
+#include <new>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#ifdef VL_VECTOR_STATS
+#include "vl_vector_stats.h"
+#endif
 
 /**
  * DEFAULT_STATIC_CAPACITY default static capacity for the vector
@@ -18,38 +33,700 @@
  */
 #define INVALID_RANGE_ERROR_MSG "Invalid range!"
 
+/**
+ * MAX_SIZE_ERROR_MSG error message text in case the vector would exceed its
+ * maximal size
+ */
+#define MAX_SIZE_ERROR_MSG "Vector size limit exceeded!"
+
 /**
  * INITIAL_VEC_SIZE initial size for the vecotr
  */
 #define INITIAL_VEC_SIZE 0
 
+/**
+ * DEFAULT_GROWTH_POLICY growth policy of VLVector's dynamic array (chosen by
+ * vl_vector_benchmark.cpp)
+ */
+#define DEFAULT_GROWTH_POLICY GrowOneAndHalf
+
+/**
+ * VL_CONSTEXPR20 constexpr from C++20 on (constexpr destructors, try blocks
+ * and std::construct_at): the static array path of VLVector can then run in
+ * constant evaluation
+ */
+#if __cplusplus >= 202002L
+#define VL_CONSTEXPR20 constexpr
+#else
+#define VL_CONSTEXPR20
+#endif
+
+/**
+ * VL_SIMD_BYTES width of the vectors used by VLVector's search and compare
+ * kernels (GCC/Clang vector extensions), 0 when they aren't available
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__AVX2__)
+#define VL_SIMD_BYTES 32
+#else
+#define VL_SIMD_BYTES 16
+#endif
+#else
+#define VL_SIMD_BYTES 0
+#endif
+
+/**
+ * SIMD_COUNT_FLUSH amount of vectors counted in the per lane counters
+ * before they are summed (a 1 byte lane holds up to 127)
+ */
+#define SIMD_COUNT_FLUSH 127
+
+/**
+ * VL_STATS_HOOK(statement) runs a VLVectorStats update (see
+ * vl_vector_stats.h) when built with VL_VECTOR_STATS, outside constant
+ * evaluation. compiles to nothing otherwise
+ */
+#ifdef VL_VECTOR_STATS
+#define VL_STATS_HOOK(statement) \
+  do { \
+    if (!IsConstantEvaluated()) { \
+      statement; \
+    } \
+  } while (0)
+#else
+#define VL_STATS_HOOK(statement) ((void) 0)
+#endif
+
 #ifndef EX6__VL_VECTOR_H_
 #define EX6__VL_VECTOR_H_
 
-template<typename T, size_t StaticCapacity = DEFAULT_STATIC_CAPACITY>
-class VLVector {
-  T static_arr_[StaticCapacity];
-  T *dynamic_arr_;
+/**
+ * ShrinkNever shrink policy- once the vector moved to the dynamic array it
+ * stays there until Clear() or ShrinkToFit()
+ */
+struct ShrinkNever {
+  /**
+   * @return always false
+   */
+  static constexpr bool ShouldShrink(size_t, size_t) noexcept { return false; }
+};
+
+/**
+ * ShrinkImmediately shrink policy- moves back to the static array as soon as
+ * the elements fit in it (the original behaviour. a vector oscillating
+ * around StaticCapacity reallocates on every push/pop)
+ */
+struct ShrinkImmediately {
+  /**
+   * @param size vector's size after the removal
+   * @param static_capacity vector's static capacity
+   * @return true if size <= static_capacity
+   */
+  static constexpr bool ShouldShrink(size_t size, size_t static_capacity)
+  noexcept {
+    return size <= static_capacity;
+  }
+};
+
+/**
+ * ShrinkHysteresis shrink policy- moves back to the static array only when
+ * size * Factor <= StaticCapacity, so after a shrink at least
+ * StaticCapacity - StaticCapacity / Factor pushes are needed before the
+ * vector allocates again
+ * @tparam Factor hysteresis factor (>= 1, 1 is the same as ShrinkImmediately)
+ */
+template<size_t Factor = 2>
+struct ShrinkHysteresis {
+  static_assert(Factor >= 1, "hysteresis factor must be at least 1");
+
+  /**
+   * @param size vector's size after the removal
+   * @param static_capacity vector's static capacity
+   * @return true if size * Factor <= static_capacity
+   */
+  static constexpr bool ShouldShrink(size_t size, size_t static_capacity)
+  noexcept {
+    return size <= static_capacity / Factor;
+  }
+};
+
+/**
+ * GrowOneAndHalf growth policy- 1.5 times the required size (the original
+ * behaviour)
+ */
+struct GrowOneAndHalf {
+  /**
+   * @param required amount of elements the vector must be able to hold
+   * @return capacity to allocate (>= required)
+   */
+  static constexpr size_t NewCapacity(size_t required, size_t) noexcept {
+    return required > SIZE_MAX / 3 ? required : (3 * required) / 2;
+  }
+};
+
+/**
+ * GrowDouble growth policy- twice the required size (fewer reallocations,
+ * up to 2x memory)
+ */
+struct GrowDouble {
+  /**
+   * @param required amount of elements the vector must be able to hold
+   * @return capacity to allocate (>= required)
+   */
+  static constexpr size_t NewCapacity(size_t required, size_t) noexcept {
+    return required > SIZE_MAX / 2 ? required : 2 * required;
+  }
+};
+
+/**
+ * GrowPowerOfTwo growth policy- the smallest power of two >= the required
+ * size
+ */
+struct GrowPowerOfTwo {
+  /**
+   * @param required amount of elements the vector must be able to hold
+   * @return capacity to allocate (>= required)
+   */
+  static constexpr size_t NewCapacity(size_t required, size_t) noexcept {
+    size_t capacity = 1;
+    while (capacity < required && capacity <= SIZE_MAX / 2) {
+      capacity *= 2;
+    }
+    return capacity < required ? required : capacity;
+  }
+};
+
+/**
+ * GrowSizeClass growth policy- 1.5 times the required size, with the
+ * array's byte size rounded up to the malloc size class it lands in anyway
+ * (16 bytes granularity up to 128 bytes, then 4 classes per power of two,
+ * like jemalloc/tcmalloc), so the allocator's slack becomes capacity
+ */
+struct GrowSizeClass {
+  /**
+   * @param required amount of elements the vector must be able to hold
+   * @param element_size sizeof of one element
+   * @return capacity to allocate (>= required)
+   */
+  static constexpr size_t NewCapacity(size_t required, size_t element_size)
+  noexcept {
+    size_t capacity = GrowOneAndHalf::NewCapacity(required, element_size);
+    if (capacity > SIZE_MAX / 2 / element_size) {
+      return capacity;
+    }
+    size_t bytes = capacity * element_size;
+    size_t step = 16;
+    if (bytes > 128) {
+      size_t group = 128;
+      while (group * 2 < bytes) {
+        group *= 2;
+      }
+      step = group / 4;
+    }
+    return ((bytes + step - 1) / step * step) / element_size;
+  }
+};
+
+/**
+ * VLVectorAllocator default allocator of VLVector's dynamic array.
+ * trivially copyable (not over aligned) elements get malloc memory that
+ * reallocate() can grow in place with realloc, other elements get operator
+ * new memory
+ * @tparam T elements type
+ */
+template<typename T>
+class VLVectorAllocator {
+  /**
+   * @return true if the arrays are allocated with malloc
+   */
+  static constexpr bool UsesMalloc() noexcept {
+    return std::is_trivially_copyable<T>::value &&
+        alignof(T) <= alignof(std::max_align_t);
+  }
+
+  /**
+   * @return true if operator new must be given T's alignment
+   */
+  static constexpr bool IsOverAligned() noexcept {
+    return alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+  }
+
+ public:
+  /**
+   * allocated elements type
+   */
+  typedef T value_type;
+  /**
+   * all VLVectorAllocators are interchangeable
+   */
+  typedef std::true_type is_always_equal;
+
+  /**
+   * Default constructor
+   */
+  VLVectorAllocator() noexcept = default;
+
+  /**
+   * converting constructor (the allocator has no state)
+   */
+  template<typename U>
+  constexpr VLVectorAllocator(const VLVectorAllocator<U> &) noexcept {}
+
+  /**
+   * allocates raw array of n cells
+   * @param n amount of cells
+   * @return pointer to the array
+   */
+  T *allocate(size_t n) {
+    if (n > SIZE_MAX / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    if constexpr (UsesMalloc()) {
+      void *arr = std::malloc(n * sizeof(T));
+      if (arr == nullptr) {
+        throw std::bad_alloc();
+      }
+      return static_cast<T *>(arr);
+    } else if constexpr (IsOverAligned()) {
+      return static_cast<T *>(::operator new(n * sizeof(T),
+                                             std::align_val_t(alignof(T))));
+    } else {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+  }
+
+  /**
+   * frees array returned from allocate
+   * @param arr array to free
+   */
+  void deallocate(T *arr, size_t) noexcept {
+    if constexpr (UsesMalloc()) {
+      std::free(arr);
+    } else if constexpr (IsOverAligned()) {
+      ::operator delete(arr, std::align_val_t(alignof(T)));
+    } else {
+      ::operator delete(arr);
+    }
+  }
+
+  /**
+   * resizes array returned from allocate with realloc, keeping its content
+   * (only for malloc arrays). VLVector uses it when it exists
+   * @param arr array to resize
+   * @param new_n new amount of cells
+   * @return pointer to the resized array
+   */
+  template<typename U = T, typename = typename std::enable_if<
+      VLVectorAllocator<U>::UsesMalloc()>::type>
+  T *reallocate(T *arr, size_t, size_t new_n) {
+    if (new_n > SIZE_MAX / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    void *resized = std::realloc(arr, new_n * sizeof(T));
+    if (resized == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(resized);
+  }
+
+  template<typename U>
+  friend class VLVectorAllocator;
+};
+
+/**
+ * @return true (VLVectorAllocators are interchangeable)
+ */
+template<typename T, typename U>
+constexpr bool operator==(const VLVectorAllocator<T> &,
+                const VLVectorAllocator<U> &) noexcept {
+  return true;
+}
+
+/**
+ * @return false (VLVectorAllocators are interchangeable)
+ */
+template<typename T, typename U>
+constexpr bool operator!=(const VLVectorAllocator<T> &,
+                const VLVectorAllocator<U> &) noexcept {
+  return false;
+}
+
+/**
+ * VLVectorAllocatorHolder keeps VLVector's allocator. empty allocators
+ * (std::allocator, VLVectorAllocator) are a base class so they take no space
+ * @tparam Allocator allocator type
+ */
+template<typename Allocator, bool = std::is_empty<Allocator>::value &&
+    !std::is_final<Allocator>::value>
+class VLVectorAllocatorHolder : private Allocator {
+ protected:
+  /**
+   * @param alloc allocator to keep
+   */
+  constexpr explicit VLVectorAllocatorHolder(const Allocator &alloc) noexcept
+      : Allocator(alloc) {}
+
+  /**
+   * @return the kept allocator
+   */
+  constexpr Allocator &Alloc() noexcept { return *this; }
+
+  /**
+   * @return the kept allocator
+   */
+  constexpr const Allocator &Alloc() const noexcept { return *this; }
+};
+
+template<typename Allocator>
+class VLVectorAllocatorHolder<Allocator, false> {
+  Allocator alloc_;
+ protected:
+  /**
+   * @param alloc allocator to keep
+   */
+  constexpr explicit VLVectorAllocatorHolder(const Allocator &alloc) noexcept
+      : alloc_(alloc) {}
+
+  /**
+   * @return the kept allocator
+   */
+  constexpr Allocator &Alloc() noexcept { return alloc_; }
+
+  /**
+   * @return the kept allocator
+   */
+  constexpr const Allocator &Alloc() const noexcept { return alloc_; }
+};
+
+/**
+ * HasReallocate true if Allocator has reallocate(ptr, old_n, new_n) (see
+ * VLVectorAllocator)
+ */
+template<typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template<typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(
+    std::declval<Allocator &>().reallocate(
+        std::declval<typename Allocator::value_type *>(), size_t(),
+        size_t()))>> : std::true_type {};
+
+/**
+ * VLVectorSimd search and compare kernels over arrays of T working on
+ * VL_SIMD_BYTES vectors, for arithmetic T (except bool and long double).
+ * for other T Enabled() is false and VLVector uses the std algorithms
+ * @tparam T elements type
+ */
+template<typename T, bool = VL_SIMD_BYTES != 0 &&
+    std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+    sizeof(T) <= 8>
+struct VLVectorSimd {
+  /**
+   * @return false: no kernels for T
+   */
+  static constexpr bool Enabled() noexcept { return false; }
+};
+
+#if VL_SIMD_BYTES != 0
+template<typename T>
+struct VLVectorSimd<T, true> {
+ private:
+  typedef T Vec __attribute__((vector_size(VL_SIMD_BYTES)));
+  //result of a lane wise comparison: all bits set in the matching lanes
+  typedef decltype(Vec() == Vec()) Mask;
+  static constexpr size_t Lanes = VL_SIMD_BYTES / sizeof(T);
+
+  /**
+   * @param arr first of Lanes elements (any alignment)
+   * @return vector of the elements
+   */
+  static Vec Load(const T *arr) noexcept {
+    Vec vec;
+    std::memcpy(&vec, arr, sizeof(Vec));
+    return vec;
+  }
+
+  /**
+   * @param mask comparison result
+   * @return true if any lane matched
+   */
+  static bool Any(Mask mask) noexcept {
+    uint64_t words[VL_SIMD_BYTES / 8];
+    std::memcpy(words, &mask, sizeof(mask));
+    uint64_t any = 0;
+    for (uint64_t word : words) {
+      any |= word;
+    }
+    return any != 0;
+  }
+
+ public:
+  /**
+   * @return true: T has kernels
+   */
+  static constexpr bool Enabled() noexcept { return true; }
+
+  /**
+   * @param arr array to search
+   * @param n amount of elements
+   * @param value value to look for
+   * @return index of the first element == value, n if there is none
+   */
+  static size_t Find(const T *arr, size_t n, T value) noexcept {
+    Vec needle = Vec{} + value;
+    size_t i = 0;
+    //four vectors per test of the mask, then one at a time
+    for (; i + 4 * Lanes <= n; i += 4 * Lanes) {
+      if (Any((Load(arr + i) == needle) | (Load(arr + i + Lanes) == needle) |
+          (Load(arr + i + 2 * Lanes) == needle) |
+          (Load(arr + i + 3 * Lanes) == needle))) {
+        break;
+      }
+    }
+    for (; i + Lanes <= n; i += Lanes) {
+      if (Any(Load(arr + i) == needle)) {
+        break;
+      }
+    }
+    for (; i < n; ++i) {
+      if (arr[i] == value) {
+        return i;
+      }
+    }
+    return n;
+  }
+
+  /**
+   * @param arr array to search
+   * @param n amount of elements
+   * @param value value to count
+   * @return amount of elements == value
+   */
+  static size_t Count(const T *arr, size_t n, T value) noexcept {
+    Vec needle = Vec{} + value;
+    size_t count = 0, i = 0;
+    while (i + Lanes <= n) {
+      //a match subtracts -1 from its lane
+      Mask lanes = Mask{};
+      for (size_t block = 0; block < SIMD_COUNT_FLUSH && i + Lanes <= n;
+           ++block, i += Lanes) {
+        lanes -= Load(arr + i) == needle;
+      }
+      for (size_t j = 0; j < Lanes; ++j) {
+        count += size_t(lanes[j]);
+      }
+    }
+    for (; i < n; ++i) {
+      count += arr[i] == value;
+    }
+    return count;
+  }
+
+  /**
+   * @param first first array
+   * @param second second array
+   * @param n amount of elements in each
+   * @return true if first[i] == second[i] for every i
+   */
+  static bool Equal(const T *first, const T *second, size_t n) noexcept {
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+      if (Any(Load(first + i) != Load(second + i))) {
+        return false;
+      }
+    }
+    for (; i < n; ++i) {
+      if (first[i] != second[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @tparam Less true for the minimum, false for the maximum
+   * @param arr array to reduce (n > 0)
+   * @param n amount of elements
+   * @return the minimal/maximal value
+   */
+  template<bool Less>
+  static T Extreme(const T *arr, size_t n) noexcept {
+    T result = arr[0];
+    size_t i = 0;
+    if (n >= Lanes) {
+      Vec lanes = Load(arr);
+      for (i = Lanes; i + Lanes <= n; i += Lanes) {
+        Vec block = Load(arr + i);
+        lanes = (Less ? block < lanes : block > lanes) ? block : lanes;
+      }
+      for (size_t j = 0; j < Lanes; ++j) {
+        result = (Less ? lanes[j] < result : lanes[j] > result) ? lanes[j] :
+                 result;
+      }
+    }
+    for (; i < n; ++i) {
+      result = (Less ? arr[i] < result : arr[i] > result) ? arr[i] : result;
+    }
+    return result;
+  }
+};
+#endif
+
+/**
+ * variable length vector: keeps up to StaticCapacity elements in the object
+ * itself and moves to a dynamic array when it grows past it
+ * @tparam T elements type
+ * @tparam StaticCapacity amount of elements stored without allocating
+ * @tparam ShrinkPolicy when to move back from the dynamic array to the
+ * static array after removals (ShrinkNever, ShrinkImmediately,
+ * ShrinkHysteresis<Factor>)
+ * @tparam Allocator allocator of the dynamic array (std::allocator
+ * compatible, e.g. std::pmr::polymorphic_allocator<T>). only the dynamic
+ * array comes from it: elements are constructed directly and the static
+ * array is never allocated. it is propagated on copy/move/swap according
+ * to std::allocator_traits
+ * @tparam GrowthPolicy capacity of the dynamic array for a required size
+ * (GrowOneAndHalf, GrowDouble, GrowPowerOfTwo, GrowSizeClass)
+ * @tparam SizeType unsigned type the size and capacity are stored in. its
+ * top bit holds the Reserve() pin, so the vector holds up to half its range
+ * (see CompactVLVector)
+ *
+ * in C++20, for trivial T (std::is_trivial), a vector that stays in its
+ * static array can be built in constant evaluation (constructors,
+ * PushBack/EmplaceBack, Insert, Erase, PopBack, operator[], iterators...),
+ * e.g. a constexpr lookup table. growing past StaticCapacity there is not a
+ * constant expression
+ */
+template<typename T, size_t StaticCapacity = DEFAULT_STATIC_CAPACITY,
+    typename ShrinkPolicy = ShrinkHysteresis<>,
+    typename Allocator = VLVectorAllocator<T>,
+    typename GrowthPolicy = DEFAULT_GROWTH_POLICY,
+    typename SizeType = size_t>
+class VLVector : private VLVectorAllocatorHolder<Allocator> {
+  static_assert(std::is_same<typename Allocator::value_type, T>::value,
+                "Allocator::value_type must be T");
+  typedef std::allocator_traits<Allocator> AllocTraits;
+  using VLVectorAllocatorHolder<Allocator>::Alloc;
+
+  static_assert(std::is_integral<SizeType>::value &&
+                    std::is_unsigned<SizeType>::value,
+                "SizeType must be an unsigned integer type");
+  static_assert(StaticCapacity <= (SizeType(-1) >> 1),
+                "StaticCapacity doesn't fit in SizeType");
+
+  //the static array or the dynamic array (capacity > StaticCapacity)
   T *data_;
-  size_t cur_size_;
-  size_t cur_cap_;
+  SizeType cur_size_;
+  //top bit: capacity was pinned by Reserve() (see PinBit)
+  SizeType cur_cap_;
+  //trivial T is kept as a T array (usable in constant evaluation), other T
+  //as raw bytes
+  typedef typename std::conditional<std::is_trivial<T>::value, T,
+                                    unsigned char>::type StaticCell;
+  //raw storage: only the cells in [0, cur_size_) hold constructed elements
+  alignas(T) StaticCell static_arr_[StaticCapacity * sizeof(T) /
+      sizeof(StaticCell)];
+
+  /**
+   * @return the bit of cur_cap_ set when the capacity was pinned by
+   * Reserve(): removals never move back to static
+   */
+  static constexpr SizeType PinBit() noexcept {
+    return SizeType(SizeType(1) << (sizeof(SizeType) * 8 - 1));
+  }
 
   /**
-   * push all elements from 'push_from' position by 'how_many' cells
-   * @param push_from index to push from
-   * @param how_many how many cells to push forward
+   * @return maximal capacity (and size) the vector can have
    */
-  void PushAllForward(size_t push_from, size_t how_many) noexcept;
+  static constexpr size_t MaxCapacity() noexcept {
+    return size_t(PinBit() - 1);
+  }
+
+  /**
+   * sets the capacity, keeping the Reserve() pin
+   * @param capacity new capacity (<= MaxCapacity())
+   */
+  VL_CONSTEXPR20 void SetCapacity(size_t capacity) noexcept {
+    cur_cap_ = SizeType(capacity) | SizeType(cur_cap_ & PinBit());
+  }
+
+  /**
+   * @return true if the capacity was pinned by Reserve()
+   */
+  constexpr bool IsPinned() const noexcept {
+    return (cur_cap_ & PinBit()) != 0;
+  }
+
+  /**
+   * pins/unpins the capacity
+   * @param pinned true to pin
+   */
+  VL_CONSTEXPR20 void SetPinned(bool pinned) noexcept {
+    cur_cap_ = pinned ? SizeType(cur_cap_ | PinBit()) :
+               SizeType(cur_cap_ & ~PinBit());
+  }
+
+  /**
+   * inserts the 'count' elements of [first, last) at 'index' (index <=
+   * cur_size_, count > 0) with one capacity decision and block moves of the
+   * tail. if the elements don't fit, the new elements, the prefix and the
+   * tail are built straight into their places in a new array (the vector is
+   * unchanged if this throws). otherwise the tail is shifted in place
+   * @param index index of the first inserted element
+   * @param first iterator to the first element to insert
+   * @param last iterator to one past the last element to insert
+   * @param count std::distance(first, last)
+   */
+  template<typename ForwardIterator>
+  VL_CONSTEXPR20 void InsertRange(size_t index, ForwardIterator first,
+                                  ForwardIterator last, size_t count);
 
   /**
    * expands the data array capacity by increasing its size (or creating new
    * dynamic array in case we used the static array so far) and copying all
    * elements from old array to new array + free old array if needed
    * @param to_add amount of elements to add
-   * @param is_using_dynamic boolean variable saying if at the beginning of
-   * the function we use the dynamic array
    */
-  void ExpandDataArray(size_t to_add, bool is_using_dynamic);
+  VL_CONSTEXPR20 void ExpandDataArray(size_t to_add) {
+    Reallocate(CalculateCapacity(cur_size_, to_add));
+  }
+
+  /**
+   * moves the elements to a new dynamic array of exactly 'capacity' cells
+   * (capacity > StaticCapacity, capacity >= cur_size_) and frees the old
+   * dynamic array if needed
+   * @param capacity capacity of the new array
+   */
+  void Reallocate(size_t capacity);
+
+  /**
+   * moves the elements back to the static array and frees the dynamic array
+   * (the vector must use the dynamic array and cur_size_ <= StaticCapacity).
+   * if copying an element throws the vector is left as it was
+   * @return true if the vector moved to the static array
+   */
+  bool MoveToStatic() noexcept;
+
+  /**
+   * called after elements were removed: moves back to the static array if
+   * the shrink policy says so and the capacity isn't pinned by Reserve()
+   */
+  VL_CONSTEXPR20 void ShrinkAfterRemoval() noexcept {
+    if (IsUsingDynamic() && !IsPinned() &&
+        ShrinkPolicy::ShouldShrink(cur_size_, StaticCapacity) &&
+        MoveToStatic()) {
+      VL_STATS_HOOK(Stats().RecordShrinkBack());
+    }
+  }
+
+#ifdef VL_VECTOR_STATS
+  /**
+   * @return the stats shared by the vectors of this T and StaticCapacity
+   */
+  static VLVectorStats &Stats() noexcept {
+    return VLVectorStatsFor<T, StaticCapacity>();
+  }
+#endif
 
   /**
    * by checking the size of the vector after the addition of 'to_add'
@@ -57,7 +734,7 @@ class VLVector {
    * @param to_add amount of elements to add
    * @return true is size after addition > static capacity, false otherwise
    */
-  inline bool ShouldUseDynamic(size_t to_add) const noexcept {
+  constexpr bool ShouldUseDynamic(size_t to_add) const noexcept {
     return (cur_size_ + to_add) > StaticCapacity;
   }
 
@@ -66,22 +743,243 @@ class VLVector {
    * dynamic array
    * @return true is we uses the dynamic array, false if we use the static array
    */
-  inline bool IsUsingDynamic() const noexcept {
-    return cur_cap_ >
-        StaticCapacity;
+  constexpr bool IsUsingDynamic() const noexcept {
+    return Capacity() > StaticCapacity;
   }
 
+  /**
+   * @return pointer to the first cell of the static array
+   */
+  VL_CONSTEXPR20 T *StaticData() noexcept {
+    if constexpr (std::is_trivial<T>::value) {
+      return static_arr_;
+    } else {
+      return reinterpret_cast<T *>(static_arr_);
+    }
+  }
+
+  /**
+   * @return true when called during constant evaluation (C++20), where
+   * memcpy/memmove and placement new can't be used
+   */
+  static constexpr bool IsConstantEvaluated() noexcept {
+#if __cplusplus >= 202002L
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * constructs an element in a raw cell (std::construct_at from C++20, so it
+   * works in constant evaluation)
+   * @param cell raw cell to construct in
+   * @param args arguments for T's constructor
+   */
+  template<typename... Args>
+  static VL_CONSTEXPR20 void ConstructAt(T *cell, Args &&... args) {
+#if __cplusplus >= 202002L
+    std::construct_at(cell, std::forward<Args>(args)...);
+#else
+    ::new(static_cast<void *>(cell)) T(std::forward<Args>(args)...);
+#endif
+  }
+
+  /**
+   * memcpy of the trivially relocatable elements in [first, last) to the
+   * cells starting at dest, which don't overlap them (element by element in
+   * constant evaluation)
+   * @param first first element to copy
+   * @param last one past the last element to copy
+   * @param dest first cell to copy to
+   */
+  static VL_CONSTEXPR20 void CopyCells(const T *first, const T *last,
+                                       T *dest) noexcept {
+    if (IsConstantEvaluated()) {
+      for (; first != last; ++first, ++dest) {
+        ConstructAt(dest, *first);
+      }
+    } else if (first != last) {
+      std::memcpy(dest, first, (last - first) * sizeof(T));
+    }
+  }
+
+  /**
+   * memmove of the trivially relocatable elements in [first, last) to the
+   * cells starting at dest, in the same array (element by element, in the
+   * right direction, in constant evaluation)
+   * @param first first element to move
+   * @param last one past the last element to move
+   * @param dest first cell to move to
+   */
+  static VL_CONSTEXPR20 void MoveCells(const T *first, const T *last,
+                                       T *dest) noexcept {
+    if (IsConstantEvaluated()) {
+      if (dest < first) {
+        for (; first != last; ++first, ++dest) {
+          ConstructAt(dest, *first);
+        }
+      } else {
+        for (dest += last - first; last != first;) {
+          ConstructAt(--dest, *--last);
+        }
+      }
+    } else if (first != last) {
+      std::memmove(dest, first, (last - first) * sizeof(T));
+    }
+  }
+
+  /**
+   * wraps an iterator so that constructing from it moves the elements when
+   * T's move constructor can't throw or T can't be copied (copies
+   * otherwise, so a throwing move can't leave both arrays half updated)
+   * @param it iterator to wrap
+   * @return std::move_iterator(it) or it
+   */
+  static constexpr typename std::conditional<
+      std::is_nothrow_move_constructible<T>::value ||
+      !std::is_copy_constructible<T>::value,
+      std::move_iterator<T *>, T *>::type
+  MoveIfNoexcept(T *it) noexcept {
+    return typename std::conditional<
+        std::is_nothrow_move_constructible<T>::value ||
+        !std::is_copy_constructible<T>::value,
+        std::move_iterator<T *>, T *>::type(it);
+  }
+
+  /**
+   * @return true if T is trivially copyable (and not over aligned): its
+   * elements are copied and relocated with memcpy/memmove (and the dynamic
+   * array grows with the allocator's reallocate, if it has one)
+   */
+  static constexpr bool IsTriviallyRelocatable() noexcept {
+    return std::is_trivially_copyable<T>::value &&
+        alignof(T) <= alignof(std::max_align_t);
+  }
+
+  /**
+   * allocates raw (unconstructed) dynamic array
+   * @param capacity amount of cells
+   * @return pointer to the new array
+   */
+  T *AllocateArray(size_t capacity) {
+    return AllocTraits::allocate(Alloc(), capacity);
+  }
+
+  /**
+   * frees dynamic array allocated with AllocateArray (elements must already
+   * be destroyed)
+   * @param arr array to free
+   * @param capacity amount of cells the array was allocated with
+   */
+  void FreeArray(T *arr, size_t capacity) noexcept {
+    AllocTraits::deallocate(Alloc(), arr, capacity);
+  }
+
+  /**
+   * destroys the elements in [first, last)
+   * @param first first element to destroy
+   * @param last one past the last element to destroy
+   */
+  static VL_CONSTEXPR20 void DestroyRange(T *first, T *last) noexcept {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+      for (; first != last; ++first) {
+        first->~T();
+      }
+    }
+  }
+
+  /**
+   * moves (see MoveIfNoexcept) the elements in [first, last) into the raw
+   * cells starting at dest and destroys the originals (one memcpy for
+   * trivially relocatable T)
+   * @param first first element to relocate
+   * @param last one past the last element to relocate
+   * @param dest first raw cell to construct in
+   */
+  static VL_CONSTEXPR20 void RelocateRange(T *first, T *last, T *dest) {
+    if constexpr (IsTriviallyRelocatable()) {
+      CopyCells(first, last, dest);
+    } else {
+      std::uninitialized_copy(MoveIfNoexcept(first), MoveIfNoexcept(last),
+                              dest);
+      DestroyRange(first, last);
+    }
+  }
+
+  /**
+   * copy constructs the elements of [first, last) into the raw cells
+   * starting at dest (one memcpy for trivially relocatable T when the
+   * iterators are pointers to T). on a throwing copy the elements built so
+   * far are destroyed
+   * @param first iterator to the first element to copy
+   * @param last iterator to one past the last element to copy
+   * @param dest first raw cell to construct in
+   */
+  template<typename InputIterator>
+  static VL_CONSTEXPR20 void ConstructRange(InputIterator first,
+                                            InputIterator last, T *dest) {
+    if constexpr (IsTriviallyRelocatable() &&
+        std::is_pointer<InputIterator>::value &&
+        std::is_same<typename std::remove_cv<typename std::remove_pointer<
+            InputIterator>::type>::type, T>::value) {
+      CopyCells(first, last, dest);
+    } else if (IsConstantEvaluated()) {
+      //std::uninitialized_copy isn't constexpr (T is trivial here)
+      for (; first != last; ++first, ++dest) {
+        ConstructAt(dest, *first);
+      }
+    } else {
+      std::uninitialized_copy(first, last, dest);
+    }
+  }
+
+  /**
+   * takes other's elements: steals its dynamic array or moves its static
+   * array elements one by one. other is left empty and static.
+   * this must be empty and static when called, and other's dynamic array
+   * must be freeable by this vector's allocator
+   * @param other vector to take the elements from
+   */
+  VL_CONSTEXPR20 void StealFrom(VLVector &other) noexcept(
+      std::is_nothrow_move_constructible<T>::value);
+
+  /**
+   * moves other's elements one by one into this vector's own storage (used
+   * when other's dynamic array can't be stolen) and clears other.
+   * this must be empty and static when called
+   * @param other vector to take the elements from
+   */
+  VL_CONSTEXPR20 void MoveElementsFrom(VLVector &other);
+
+  /**
+   * copies other's elements into this vector (this must be empty and static)
+   * @param other vector to copy from
+   */
+  VL_CONSTEXPR20 void CopyElementsFrom(const VLVector &other);
+
   /**
    * Calculates the capacity the vector should have after inserting
-   * amount_to_add more elements
+   * amount_to_add more elements (see GrowthPolicy)
    * @param cur_size current vector size
    * @param amount_to_add number of elements to add
    * @return size vector should have after the addition
+   * @throw std::length_error if the size would exceed MaxSize()
    */
-  size_t CalculateCapacity(size_t cur_size, size_t amount_to_add) const
-  noexcept {
-    return (cur_size + amount_to_add <= StaticCapacity) ? StaticCapacity :
-           std::floor((3 * (cur_size + amount_to_add)) / 2);
+  VL_CONSTEXPR20 size_t CalculateCapacity(size_t cur_size,
+                                          size_t amount_to_add) const {
+    size_t required = cur_size + amount_to_add;
+    if (required <= StaticCapacity) {
+      return StaticCapacity;
+    }
+    if (required > MaxCapacity() || required < cur_size) {
+      throw std::length_error(MAX_SIZE_ERROR_MSG);
+    }
+    size_t capacity = GrowthPolicy::NewCapacity(required, sizeof(T));
+    if (capacity > MaxCapacity()) {
+      return MaxCapacity();
+    }
+    return capacity < required ? required : capacity;
   }
 
  public:
@@ -100,37 +998,41 @@ class VLVector {
    * returns an iterator to the vector's beginning
    * @return iterator (T*) to the first cell in the data array
    */
-  iterator begin() noexcept { return data_; };
+  VL_CONSTEXPR20 iterator begin() noexcept { return data_; };
 
   /**
    * returns an iterator to the vector's end
    * @return iterator (T*) to one past the last cell in the data array
    */
-  iterator end() noexcept { return data_ + cur_size_; };
+  VL_CONSTEXPR20 iterator end() noexcept { return data_ + cur_size_; };
 
   /**
    * returns a const iterator for a const vector's beginning
    * @return const_iterator (const T*) to the first cell in the data array
    */
-  const_iterator begin() const noexcept { return data_; }
+  VL_CONSTEXPR20 const_iterator begin() const noexcept { return data_; }
 
   /**
    * returns a const iterator for a const vector's end
    * @return const_iterator (const T*) to one past the last cell in the data array
    */
-  const_iterator end() const noexcept { return data_ + cur_size_; }
+  VL_CONSTEXPR20 const_iterator end() const noexcept {
+    return data_ + cur_size_;
+  }
 
   /**
    * returns a const iterator for non-const vector's beginning
    * @return const iterator (const T*) to the first cell in the data array
    */
-  const_iterator cbegin() const noexcept { return data_; }
+  VL_CONSTEXPR20 const_iterator cbegin() const noexcept { return data_; }
 
   /**
    * returns a const iterator for non-const vector's end
    * @return const iterator (const T*) to one past the last cell in the data array
    */
-  const_iterator cend() const noexcept { return data_ + cur_size_; }
+  VL_CONSTEXPR20 const_iterator cend() const noexcept {
+    return data_ + cur_size_;
+  }
 
   /**
    * reverse iterator for VLVector
@@ -145,82 +1047,151 @@ class VLVector {
    * returns reverse iterator object starting for the vector last element
    * @return reverse iterator starting from data_[cur_size_ - 1]
    */
-  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  VL_CONSTEXPR20 reverse_iterator rbegin() { return reverse_iterator(end()); }
 
   /**
    * returns reverse iterator object pointing one cell before the vector's
    * first cell
    * @return reverse iterator pointing to data_[-1]
    */
-  reverse_iterator rend() { return reverse_iterator(begin()); }
+  VL_CONSTEXPR20 reverse_iterator rend() { return reverse_iterator(begin()); }
 
   /**
    * returns const reverse iterator object starting for a const vector's last
    * element
    * @return const reverse iterator starting from data_[cur_size_ - 1]
    */
-  const_reverse_iterator rbegin() const { return const_reverse_iterator(end());}
+  VL_CONSTEXPR20 const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
 
   /**
    * returns const reverse iterator object pointing one cell before a
    * const vector's first cell
    * @return const reverse iterator pointing to data_[-1]
    */
-  const_reverse_iterator rend() const { return const_reverse_iterator(begin());}
+  VL_CONSTEXPR20 const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
 
   /**
    * returns const reverse iterator object starting for a vector's last
    * element
    * @return const reverse iterator starting from data_[cur_size_ - 1]
    */
-  const_reverse_iterator crbegin() const { return const_reverse_iterator(end());}
+  VL_CONSTEXPR20 const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(end());
+  }
 
   /**
    * returns const reverse iterator object pointing one cell before a
    * const vector's first cell
    * @return const reverse iterator pointing to data_[-1]
    */
-  const_reverse_iterator crend() const { return const_reverse_iterator(begin());}
+  VL_CONSTEXPR20 const_reverse_iterator crend() const {
+    return const_reverse_iterator(begin());
+  }
   //_________________________constructors___________________________
   /**
    * Default constructor
    */
-  VLVector() noexcept: dynamic_arr_(nullptr), data_(static_arr_), cur_size_
-      (INITIAL_VEC_SIZE), cur_cap_(StaticCapacity) {}
+  VL_CONSTEXPR20 VLVector() noexcept(noexcept(Allocator()))
+      : VLVector(Allocator()) {}
+
+  /**
+   * Constructor for an empty vector that allocates from alloc
+   * @param alloc allocator for the dynamic array
+   */
+  VL_CONSTEXPR20 explicit VLVector(const Allocator &alloc) noexcept
+      : VLVectorAllocatorHolder<Allocator>(alloc), data_(StaticData()),
+        cur_size_(INITIAL_VEC_SIZE), cur_cap_(StaticCapacity) {
+    if constexpr (std::is_trivial<T>::value) {
+      if (IsConstantEvaluated()) {
+        //a constant's cells must all be initialized
+        for (size_t i = 0; i < StaticCapacity; ++i) {
+          ConstructAt(static_arr_ + i);
+        }
+      }
+    }
+  }
 
   /**
    * Copy constructor- creates new vector with the same elements type and
-   * static capacity as other and copying all elements from other to new vector
+   * static capacity as other and copying all elements from other to new
+   * vector. the allocator is
+   * select_on_container_copy_construction(other's allocator)
    * @param other vector to copy from
    */
-  VLVector(const VLVector &other) noexcept(false): VLVector() { *this = other; }
+  VL_CONSTEXPR20 VLVector(const VLVector &other) noexcept(false)
+      : VLVector(AllocTraits::select_on_container_copy_construction(
+      other.Alloc())) {
+    CopyElementsFrom(other);
+  }
+
+  /**
+   * Move constructor- takes other's allocator and dynamic array without
+   * copying, or moves other's elements if it uses the static array. other
+   * is left empty
+   * @param other vector to move from
+   */
+  VL_CONSTEXPR20 VLVector(VLVector &&other) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : VLVector(other.Alloc()) {
+    StealFrom(other);
+  }
 
   /**
    * Constructor initialize new vector with 'count' times the element 'elem'
    * @param count the amount that elem needs to be added to the vector
    * @param elem element of type T to add to the vector
+   * @param alloc allocator for the dynamic array
    */
-  VLVector(size_t count, const T &elem) noexcept(false);
+  VL_CONSTEXPR20 VLVector(size_t count, const T &elem,
+                          const Allocator &alloc = Allocator())
+  noexcept(false);
 
+  /**
+   * Constructor initialize new vector with the elements in [first, last)
+   * @param first iterator to the first element to copy
+   * @param last iterator to one past the last element to copy
+   * @param alloc allocator for the dynamic array
+   */
   template<typename InputIterator>
-  VLVector(InputIterator first, InputIterator last);
+  VL_CONSTEXPR20 VLVector(InputIterator first, InputIterator last,
+           const Allocator &alloc = Allocator());
 
   /**
-   * Destructor for the vector- freeing data array in case that vector using
-   * the dynamic array to store data
+   * Destructor for the vector- destroying the elements and freeing data
+   * array in case that vector using the dynamic array to store data
    */
-  ~VLVector() noexcept {
+  VL_CONSTEXPR20 ~VLVector() noexcept {
+    DestroyRange(begin(), end());
     if (this->IsUsingDynamic()) {
-      delete[] data_;
+      FreeArray(data_, Capacity());
     }
   }
   //_________________________operators___________________________
   /**
-   * = operator. creates new vector which is the exact copy of other
+   * = operator. creates new vector which is the exact copy of other (takes
+   * other's allocator if propagate_on_container_copy_assignment)
    * @param other vector to copy
    * @return reference to nw vector
    */
-  VLVector<T, StaticCapacity> &operator=(const VLVector &other) noexcept(false);
+  VL_CONSTEXPR20 VLVector &operator=(const VLVector &other) noexcept(false);
+
+  /**
+   * move = operator. frees this vector's data and takes other's elements
+   * (see move constructor). the dynamic array is stolen if the allocator
+   * propagates on move assignment or both allocators are equal, otherwise
+   * the elements are moved one by one into this vector's own storage.
+   * other is left empty
+   * @param other vector to move from
+   * @return reference to this vector
+   */
+  VL_CONSTEXPR20 VLVector &operator=(VLVector &&other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      (AllocTraits::propagate_on_container_move_assignment::value ||
+          AllocTraits::is_always_equal::value));
 
   /**
  * checks if the content of two vectors are equal: StaticCapacity, size,
@@ -228,7 +1199,7 @@ class VLVector {
  * @param other VLVector object to compare to
  * @return true if equals, false otherwise
  */
-  bool operator==(const VLVector &other) const noexcept;
+  VL_CONSTEXPR20 bool operator==(const VLVector &other) const noexcept;
 
   /**
    * checks if the content of two vectors are not equal: StaticCapacity, size,
@@ -236,7 +1207,7 @@ class VLVector {
    * @param other VLVector object to compare to
    * @return true if not equals, false otherwise
    */
-  bool operator!=(const VLVector &other) const noexcept {
+  VL_CONSTEXPR20 bool operator!=(const VLVector &other) const noexcept {
     return !(*this == other);
   }
 
@@ -244,29 +1215,52 @@ class VLVector {
    * returns reference to the element in index 'index' in the vector
    * @return reference to the element in the requested index in the vector
    */
-  T &operator[](size_t index) noexcept { return data_[index]; }
+  VL_CONSTEXPR20 T &operator[](size_t index) noexcept { return data_[index]; }
 
   /**
  * returns value of the element in index 'index' in the vector
  * @return value of the element in the requested index in the vector
  */
-  T operator[](size_t index) const noexcept { return data_[index]; }
+  VL_CONSTEXPR20 T operator[](size_t index) const noexcept {
+    return data_[index];
+  }
 
 //_________________________functions___________________________
   /**
    * @return current amount of elements the vector holds
    */
-  size_t Size() const noexcept { return cur_size_; }
+  VL_CONSTEXPR20 size_t Size() const noexcept { return cur_size_; }
   /**
    * @return maximum amount of elements the vector can hold in it's current
    * state
    */
-  size_t Capacity() const noexcept { return cur_cap_; }
+  VL_CONSTEXPR20 size_t Capacity() const noexcept {
+    return cur_cap_ & ~PinBit();
+  }
+
+  /**
+   * @return maximum amount of elements the vector can ever hold
+   */
+  static constexpr size_t MaxSize() noexcept { return MaxCapacity(); }
 
   /**
    * @return true is vector holds no elements or false otherwise
    */
-  bool Empty() const noexcept { return (cur_size_ == 0); }
+  VL_CONSTEXPR20 bool Empty() const noexcept { return (cur_size_ == 0); }
+
+  /**
+   * @return copy of the allocator of the dynamic array
+   */
+  Allocator GetAllocator() const noexcept { return Alloc(); }
+
+  /**
+   * swaps the content of two vectors without allocating. allocators are
+   * swapped if propagate_on_container_swap, otherwise they must be equal
+   * @param other vector to swap with
+   */
+  void Swap(VLVector &other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_swappable<T>::value);
 
   /**
    * for non constant vector returns reference to the element in index
@@ -274,7 +1268,7 @@ class VLVector {
    * @param index index of the requested element
    * @return reference to the elements in index 'index'
    */
-  T &At(size_t index) noexcept(false);
+  VL_CONSTEXPR20 T &At(size_t index) noexcept(false);
 
   /**
    * for const vector returns const reference (not changeable) to the element
@@ -282,32 +1276,107 @@ class VLVector {
    * @param index index of the requested element
    * @return const reference to the elements in the index 'index'
    */
-  T At(size_t index) const noexcept(false);
+  VL_CONSTEXPR20 T At(size_t index) const noexcept(false);
 
   /**
    * adds new element at the end of vector, switch from static array to dynamic
    * array (or the other way around) in needed (may throw exception in
    * allocation)
    */
-  void PushBack(const T &new_elem);
+  VL_CONSTEXPR20 void PushBack(const T &new_elem);
+
+  /**
+   * adds new element at the end of vector by moving it in (see PushBack)
+   */
+  VL_CONSTEXPR20 void PushBack(T &&new_elem);
+
+  /**
+   * constructs new element from args at the end of the vector
+   * @param args arguments for T's constructor
+   * @return reference to the new element
+   */
+  template<typename... Args>
+  VL_CONSTEXPR20 T &EmplaceBack(Args &&... args);
 
   /**
    * @return pointer to the array holds the data in the current state- the
    * dynamic array or the static array
    */
-  T *Data() noexcept { return data_; }
+  VL_CONSTEXPR20 T *Data() noexcept { return data_; }
 
   /**
  * @return const pointer to the array holds the data in the current state- the
  * dynamic array or the static array
  */
-  const T *Data() const { return data_; }
+  VL_CONSTEXPR20 const T *Data() const { return data_; }
+
+  /**
+   * linear search (vectorized for arithmetic T, see VLVectorSimd)
+   * @param value value to look for
+   * @return iterator to the first element == value, end() if there is none
+   */
+  VL_CONSTEXPR20 iterator Find(const T &value) {
+    return begin() + (static_cast<const VLVector &>(*this).Find(value) -
+        cbegin());
+  }
+
+  /**
+   * linear search (vectorized for arithmetic T, see VLVectorSimd)
+   * @param value value to look for
+   * @return const iterator to the first element == value, end() if there is
+   * none
+   */
+  VL_CONSTEXPR20 const_iterator Find(const T &value) const;
+
+  /**
+   * @param value value to look for
+   * @return true if an element == value
+   */
+  VL_CONSTEXPR20 bool Contains(const T &value) const {
+    return Find(value) != cend();
+  }
+
+  /**
+   * @param value value to count
+   * @return amount of elements == value
+   */
+  VL_CONSTEXPR20 size_t Count(const T &value) const;
+
+  /**
+   * @return const iterator to the first minimal element, end() if the vector
+   * is empty (vectorized for integral T. floating point T keeps
+   * std::min_element's order, which matters with NaN)
+   */
+  VL_CONSTEXPR20 const_iterator MinElement() const;
+
+  /**
+   * @return const iterator to the first maximal element, end() if the vector
+   * is empty (see MinElement)
+   */
+  VL_CONSTEXPR20 const_iterator MaxElement() const;
 
   /**
    * clears all data from the vector and resets it: free dynamic array if in
-   * use, set capacity back to Static Capacity, set size to 0
+   * use, set capacity back to Static Capacity, set size to 0 (also drops a
+   * capacity pinned by Reserve())
+   */
+  VL_CONSTEXPR20 void Clear() noexcept;
+
+  /**
+   * makes sure the vector can hold 'capacity' elements without allocating
+   * and pins its capacity: removals won't move it back to the static array
+   * (whatever the shrink policy) until ShrinkToFit() or Clear()
+   * @param capacity minimal capacity wanted
    */
-  void Clear() noexcept;
+  void Reserve(size_t capacity);
+
+  /**
+   * reduces the capacity to the size: moves back to the static array if the
+   * elements fit in it, otherwise reallocates the dynamic array to exactly
+   * Size() cells. unpins a capacity set by Reserve(). if an element's copy
+   * (or the allocation) throws the vector is left unchanged
+   */
+  void ShrinkToFit();
 
   /**
    * insert single element of type T to the vector, left to the element that
@@ -319,7 +1388,28 @@ class VLVector {
    * @param to_add element to add
    * @return iterator stats at the new element inserted
    */
-  iterator Insert(const_iterator position, const T &to_add) noexcept(false);
+  VL_CONSTEXPR20 iterator Insert(const_iterator position, const T &to_add)
+  noexcept(false);
+
+  /**
+   * insert single element of type T to the vector by moving it in (see
+   * Insert above)
+   * @param position iterator pointing to a valid position in the vector
+   * @param to_add element to move in
+   * @return iterator stats at the new element inserted
+   */
+  VL_CONSTEXPR20 iterator Insert(const_iterator position, T &&to_add)
+  noexcept(false);
+
+  /**
+   * constructs new element from args left to the element that position
+   * points to (see Insert above)
+   * @param position iterator pointing to a valid position in the vector
+   * @param args arguments for T's constructor
+   * @return iterator stats at the new element
+   */
+  template<typename... Args>
+  VL_CONSTEXPR20 iterator Emplace(const_iterator position, Args &&... args);
 
   /**
    * insert range of elements between first to last iterators, left to the
@@ -336,7 +1426,7 @@ class VLVector {
    * @return iterator stats at the most left new element inserted
    */
   template<typename InputIterator>
-  iterator Insert(const_iterator position, InputIterator first,
+  VL_CONSTEXPR20 iterator Insert(const_iterator position, InputIterator first,
                   InputIterator last)
   noexcept(false);
 
@@ -344,7 +1434,7 @@ class VLVector {
    * removes the last element in the vector. if vector is empty- return
    * without doing anything
    */
-  void PopBack() noexcept;
+  VL_CONSTEXPR20 void PopBack() noexcept;
 
   /**
    * erasing element that to iterator position points to.
@@ -356,7 +1446,7 @@ class VLVector {
    * @return iterator pointing to the element on the right from the element
    * that got removed
    */
-  iterator Erase(const_iterator position) noexcept;
+  VL_CONSTEXPR20 iterator Erase(const_iterator position) noexcept;
 
   /**
    * erasing range of elements from the vector, starting at first and ends at
@@ -367,43 +1457,86 @@ class VLVector {
    * @param last one past the last elements in range of elements to remove
    * @return iterator to the element on the right of the section got removed
    */
-  iterator Erase(const_iterator first, const_iterator last) noexcept;
+  VL_CONSTEXPR20 iterator Erase(const_iterator first, const_iterator last)
+  noexcept;
 };
 
 //single value initialized constructor
-template<typename T, size_t StaticCapacity>
-VLVector<T, StaticCapacity>::VLVector(const size_t count, const T &elem)
-noexcept(false):VLVector() {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                        GrowthPolicy, SizeType>::VLVector(
+    const size_t count, const T &elem, const Allocator &alloc)
+noexcept(false):VLVector(alloc) {
   if (this->ShouldUseDynamic(count)) {
-    cur_cap_ = CalculateCapacity(INITIAL_VEC_SIZE, count);
-    dynamic_arr_ = new T[cur_cap_];
-    data_ = dynamic_arr_;
+    size_t new_capacity = CalculateCapacity(INITIAL_VEC_SIZE, count);
+    data_ = AllocateArray(new_capacity);
+    SetCapacity(new_capacity);
+    VL_STATS_HOOK(Stats().RecordSpill());
+  }
+  try {
+    if (IsConstantEvaluated()) {
+      for (size_t i = 0; i < count; ++i) {
+        ConstructAt(data_ + i, elem);
+      }
+    } else {
+      std::uninitialized_fill_n(data_, count, elem);
+    }
+  } catch (...) {
+    if (IsUsingDynamic()) {
+      FreeArray(data_, Capacity());
+    }
+    throw;
   }
   cur_size_ = count;
-  std::fill(this->begin(), this->end(), elem);
+  VL_STATS_HOOK(Stats().RecordSize(cur_size_));
 }
 
 //iterator constructor
-template<typename T, size_t StaticCapacity>
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
 template<typename InputIterator>
-VLVector<T, StaticCapacity>::VLVector(InputIterator first, InputIterator
-last):VLVector() {
+VL_CONSTEXPR20 VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                        GrowthPolicy, SizeType>::VLVector(
+    InputIterator first, InputIterator last, const Allocator &alloc)
+    :VLVector(alloc) {
   size_t distance = std::distance(first, last);
   if (this->ShouldUseDynamic(distance)) {
-    cur_cap_ = this->CalculateCapacity(0, distance);
-    dynamic_arr_ = new T[cur_cap_];
-    data_ = dynamic_arr_;
+    size_t new_capacity = this->CalculateCapacity(0, distance);
+    data_ = AllocateArray(new_capacity);
+    SetCapacity(new_capacity);
+    VL_STATS_HOOK(Stats().RecordSpill());
+  }
+  try {
+    ConstructRange(first, last, data_);
+  } catch (...) {
+    if (IsUsingDynamic()) {
+      FreeArray(data_, Capacity());
+    }
+    throw;
   }
   cur_size_ = distance;
-  std::copy(first, last, data_);
+  VL_STATS_HOOK(Stats().RecordSize(cur_size_));
 }
 
-template<typename T, size_t StaticCapacity>
-bool VLVector<T, StaticCapacity>::operator==(const VLVector &other) const
-noexcept {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 bool VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::operator==(
+    const VLVector &other) const noexcept {
   if (cur_size_ != other.cur_size_) {
     return false;
   }
+  if (!IsConstantEvaluated()) {
+    if constexpr (std::is_integral<T>::value || std::is_enum<T>::value ||
+        std::is_pointer<T>::value) {
+      //equal values have equal bytes
+      return cur_size_ == 0 ||
+          std::memcmp(data_, other.data_, cur_size_ * sizeof(T)) == 0;
+    } else if constexpr (VLVectorSimd<T>::Enabled()) {
+      return VLVectorSimd<T>::Equal(data_, other.data_, cur_size_);
+    }
+  }
   for (size_t i = 0; i < cur_size_; ++i) {
     if (data_[i] != other.data_[i]) {
       return false;
@@ -412,90 +1545,212 @@ noexcept {
   return true;
 }
 
-template<typename T, size_t StaticCapacity>
-VLVector<T, StaticCapacity> &VLVector<T, StaticCapacity>::operator=(const
-    VLVector &other) noexcept(false) {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                        GrowthPolicy, SizeType> &
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::operator=(
+    const VLVector &other) noexcept(false) {
   if (this == &other) {
     return *this;
   }
+  //the dynamic array is freed with the allocator that allocated it
   this->Clear();
-  if (this->ShouldUseDynamic(other.cur_size_)) {
-    size_t new_capacity = (*this).CalculateCapacity(cur_size_, other.cur_size_);
-    dynamic_arr_ = new T[new_capacity];
-    data_ = dynamic_arr_;
-    cur_cap_ = new_capacity;
+  if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+    Alloc() = other.Alloc();
   }
-  cur_size_ = other.cur_size_;
+  CopyElementsFrom(other);
+  return *this;
+}
 
-  std::copy(other.cbegin(), other.cend(), this->begin());
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                        GrowthPolicy, SizeType> &
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::operator=(
+    VLVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value &&
+    (AllocTraits::propagate_on_container_move_assignment::value ||
+        AllocTraits::is_always_equal::value)) {
+  if (this == &other) {
+    return *this;
+  }
+  this->Clear();
+  if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+    Alloc() = other.Alloc();
+    StealFrom(other);
+  } else {
+    if (Alloc() == other.Alloc()) {
+      StealFrom(other);
+    } else {
+      //other's array can't be freed by our allocator
+      MoveElementsFrom(other);
+    }
+  }
   return *this;
 }
 
-template<typename T, size_t StaticCapacity>
-T &VLVector<T, StaticCapacity>::At(size_t index) noexcept(false) {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 T &VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                           GrowthPolicy, SizeType>::At(
+    size_t index) noexcept(false) {
   if (index >= cur_size_) {
     throw std::out_of_range(INDEX_ERROR_MSG);
   }
   return data_[index];
 }
 
-template<typename T, size_t StaticCapacity>
-T VLVector<T, StaticCapacity>::At(size_t index) const noexcept(false) {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 T VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+           GrowthPolicy, SizeType>::At(size_t index) const noexcept(false) {
   if (index >= cur_size_) {
     throw std::out_of_range(INDEX_ERROR_MSG);
   }
   return data_[index];
 }
 
-template<typename T, size_t StaticCapacity>
-void VLVector<T, StaticCapacity>::PushBack(const T &new_elem) {
-  if (cur_size_ == cur_cap_) {
-    ExpandDataArray(1, IsUsingDynamic());
-  }
-  data_[cur_size_++] = new_elem;
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::PushBack(const T &new_elem) {
+  EmplaceBack(new_elem);
 }
 
-template<typename T, size_t StaticCapacity>
-void VLVector<T, StaticCapacity>::Clear() noexcept {
-  if (cur_size_ == 0) {
-    return;
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::PushBack(T &&new_elem) {
+  EmplaceBack(std::move(new_elem));
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+template<typename... Args>
+VL_CONSTEXPR20 T &VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+            GrowthPolicy, SizeType>::EmplaceBack(Args &&... args) {
+  if (cur_size_ == Capacity()) {
+    //args may refer to an element of the array that is about to be freed
+    T new_elem(std::forward<Args>(args)...);
+    ExpandDataArray(1);
+    ConstructAt(data_ + cur_size_, std::move(new_elem));
+  } else {
+    ConstructAt(data_ + cur_size_, std::forward<Args>(args)...);
   }
+  ++cur_size_;
+  VL_STATS_HOOK(Stats().RecordSize(cur_size_));
+  return data_[cur_size_ - 1];
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::Clear() noexcept {
+  DestroyRange(begin(), end());
   if (this->IsUsingDynamic()) {
-    delete[] dynamic_arr_;
-    dynamic_arr_ = nullptr;
-    data_ = static_arr_;
+    FreeArray(data_, Capacity());
+    data_ = StaticData();
   }
   cur_size_ = 0;
   cur_cap_ = StaticCapacity;
 }
 
-template<typename T, size_t StaticCapacity>
-typename VLVector<T, StaticCapacity>::iterator VLVector<T,StaticCapacity>::
-    Insert(VLVector<T, StaticCapacity>::const_iterator position, const T
-    &to_add) noexcept(false) {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::Reserve(size_t capacity) {
+  if (capacity > MaxCapacity()) {
+    throw std::length_error(MAX_SIZE_ERROR_MSG);
+  }
+  if (capacity > Capacity()) {
+    Reallocate(capacity);
+  }
+  if (IsUsingDynamic()) {
+    SetPinned(true);
+  }
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::ShrinkToFit() {
+  SetPinned(false);
+  if (!IsUsingDynamic()) {
+    return;
+  }
+  if (cur_size_ <= StaticCapacity) {
+    //non binding: if copying an element throws we stay dynamic
+    MoveToStatic();
+  } else if (cur_size_ < Capacity()) {
+    Reallocate(cur_size_);
+  }
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Insert(
+    const_iterator position, const T &to_add) noexcept(false) {
+  if (position - cbegin() < 0 || position > cend()) {
+    return begin() + (position - cbegin());
+    //TODO check cases. in std::vector crush or unexpected
+  }
+  //copying first: to_add may be an element of this vector
+  return Insert(position, T(to_add));
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Insert(
+    const_iterator position, T &&to_add) noexcept(false) {
   size_t index_to_push_from = position - cbegin();
   if (index_to_push_from > cur_size_ || position - cbegin() < 0) {
     return begin() + index_to_push_from;
-    //TODO check cases. in std::vector crush or unexpected
   }
   if (index_to_push_from == cur_size_) {
-    this->PushBack(to_add);
-  } else {
-    if (cur_size_ == cur_cap_) {
-      ExpandDataArray(1, IsUsingDynamic());
-    }
-    PushAllForward(index_to_push_from, 1);
-    data_[index_to_push_from] = to_add;
-    cur_size_++;
+    this->PushBack(std::move(to_add));
+    return begin() + index_to_push_from;
   }
+  //to_add may be an element that is about to be shifted or freed
+  T moved(std::move(to_add));
+  InsertRange(index_to_push_from, std::make_move_iterator(&moved),
+              std::make_move_iterator(&moved + 1), 1);
+  VL_STATS_HOOK(Stats().RecordSize(cur_size_));
   return begin() + index_to_push_from;
 }
 
-template<typename T, size_t StaticCapacity>
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+template<typename... Args>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Emplace(
+    const_iterator position, Args &&... args) {
+  if (position == cend()) {
+    size_t index = position - cbegin();
+    EmplaceBack(std::forward<Args>(args)...);
+    return begin() + index;
+  }
+  return Insert(position, T(std::forward<Args>(args)...));
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
 template<typename InputIterator>
-typename VLVector<T, StaticCapacity>::iterator VLVector<T, StaticCapacity>::
-Insert(VLVector<T, StaticCapacity>::const_iterator position,
-       InputIterator first, InputIterator last) noexcept(false) {
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Insert(
+    const_iterator position, InputIterator first, InputIterator last)
+    noexcept(false) {
   size_t index_to_push_from = position - cbegin();
   if (index_to_push_from > cur_size_ || position - cbegin() < 0) {
     return begin() + index_to_push_from;
@@ -504,59 +1759,49 @@ Insert(VLVector<T, StaticCapacity>::const_iterator position,
     throw std::length_error(INVALID_RANGE_ERROR_MSG);
   }
   size_t elems_to_add = std::distance(first, last);
-  if (cur_size_ + elems_to_add >= cur_cap_) {
-    ExpandDataArray(elems_to_add, IsUsingDynamic());
-  }
-  PushAllForward(index_to_push_from, elems_to_add);
-  size_t i = 0;
-  for (auto it = first; it != last; ++it) {
-    data_[index_to_push_from + i] = *it;
-    i++;
+  if (elems_to_add == 0) {
+    return begin() + index_to_push_from;
   }
-  cur_size_ += elems_to_add;
+  InsertRange(index_to_push_from, first, last, elems_to_add);
+  VL_STATS_HOOK(Stats().RecordSize(cur_size_));
   return begin() + index_to_push_from;
 }
 
-template<typename T, size_t StaticCapacity>
-void VLVector<T, StaticCapacity>::PopBack() noexcept {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::PopBack() noexcept {
   if (cur_size_ == 0) {
     return;
   }
-  //dynamic->static
-  if (IsUsingDynamic() && cur_size_ - 1 == StaticCapacity) {
-    std::copy(cbegin(), cend() - 1, static_arr_);
-    delete[] dynamic_arr_;
-    dynamic_arr_ = nullptr;
-    data_ = static_arr_;
-    cur_cap_ = StaticCapacity;
-  }
-  //static->static and dynamic->dynamic
-  cur_size_--;
+  --cur_size_;
+  DestroyRange(end(), end() + 1);
+  //dynamic->static if the shrink policy says so
+  ShrinkAfterRemoval();
 }
 
-template<typename T, size_t StaticCapacity>
-typename VLVector<T, StaticCapacity>::iterator VLVector<T,
-                                                        StaticCapacity>::Erase(
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Erase(
     const_iterator position) noexcept {
   if (position - cend() >= 0 || cur_size_ == 0) {
     return end();
   }
-  long index_to_remove = position - cbegin();
-  if (index_to_remove < 0) {
-    index_to_remove = 0;
+  if (position - cbegin() < 0) {
     position = cbegin();
   }
-  size_t index = index_to_remove;
-  for (auto it = position + 1; it != cend(); ++it) {
-    data_[index++] = *it;
-  }
-  this->PopBack();
-  return begin() + index_to_remove;
+  return Erase(position, position + 1);
 }
 
-template<typename T, size_t StaticCapacity>
-typename VLVector<T, StaticCapacity>::iterator VLVector<T,
-                                                        StaticCapacity>::Erase(
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Erase(
     const_iterator first, const_iterator last) noexcept {
 
   if (last - cend() > 0 || first - last > 0) {
@@ -566,44 +1811,332 @@ typename VLVector<T, StaticCapacity>::iterator VLVector<T,
   if (first == last) {
     return begin() + index_to_erase_from;
   }
-  size_t amount_to_remove = last - first;
+  //one block move of the tail, then one shrink decision
+  iterator new_end;
+  if constexpr (IsTriviallyRelocatable()) {
+    size_t index_to_keep_from = last - cbegin();
+    MoveCells(begin() + index_to_keep_from, end(),
+              begin() + index_to_erase_from);
+    new_end = end() - (index_to_keep_from - index_to_erase_from);
+  } else {
+    new_end = std::move(begin() + (last - cbegin()), end(),
+                        begin() + index_to_erase_from);
+    DestroyRange(new_end, end());
+  }
+  cur_size_ = new_end - begin();
+  ShrinkAfterRemoval();
+  return begin() + index_to_erase_from;
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::const_iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Find(const T &value) const {
+  if constexpr (VLVectorSimd<T>::Enabled()) {
+    if (!IsConstantEvaluated()) {
+      return cbegin() + VLVectorSimd<T>::Find(data_, cur_size_, value);
+    }
+  }
+  return std::find(cbegin(), cend(), value);
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 size_t VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                               GrowthPolicy, SizeType>::Count(
+    const T &value) const {
+  if constexpr (VLVectorSimd<T>::Enabled()) {
+    if (!IsConstantEvaluated()) {
+      return VLVectorSimd<T>::Count(data_, cur_size_, value);
+    }
+  }
+  return std::count(cbegin(), cend(), value);
+}
 
-  iterator it = begin() + index_to_erase_from;
-  for (; last != cend(); ++last, ++it) {
-    *it = *last;
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::const_iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::MinElement() const {
+  if constexpr (VLVectorSimd<T>::Enabled() && std::is_integral<T>::value) {
+    if (!IsConstantEvaluated() && cur_size_ != 0) {
+      //the minimal value, then its first position
+      return Find(VLVectorSimd<T>::template Extreme<true>(data_, cur_size_));
+    }
   }
-  while (amount_to_remove != 0) {
-    PopBack();
-    amount_to_remove--;
+  return std::min_element(cbegin(), cend());
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 typename VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                  GrowthPolicy, SizeType>::const_iterator
+VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::MaxElement() const {
+  if constexpr (VLVectorSimd<T>::Enabled() && std::is_integral<T>::value) {
+    if (!IsConstantEvaluated() && cur_size_ != 0) {
+      return Find(VLVectorSimd<T>::template Extreme<false>(data_, cur_size_));
+    }
   }
-  return begin() + (first - cbegin());
+  return std::max_element(cbegin(), cend());
 }
 
 //__________________________private functions________________________________
-template<typename T, size_t StaticCapacity>
-void VLVector<T, StaticCapacity>::ExpandDataArray(size_t to_add, bool
-is_using_dynamic) {
-  size_t tmp_cap = CalculateCapacity(cur_size_, to_add);
-  T *tmp = new T[tmp_cap];
-  std::copy(this->cbegin(), this->cend(), tmp);
-  if (is_using_dynamic) {
-    delete[] data_;
-  }
-  cur_cap_ = tmp_cap;
-  dynamic_arr_ = tmp;
-  data_ = dynamic_arr_;
-}
-
-template<typename T, size_t StaticCapacity>
-void VLVector<T, StaticCapacity>::PushAllForward(size_t push_from, size_t
-how_many) noexcept {
-  if (push_from == cur_size_) {
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::Reallocate(size_t capacity) {
+  if (capacity > Capacity()) {
+    VL_STATS_HOOK(Stats().RecordExpansion(!IsUsingDynamic(),
+                                          cur_size_ * sizeof(T)));
+  }
+  if constexpr (IsTriviallyRelocatable() && HasReallocate<Allocator>::value) {
+    //grows (or shrinks) in place when the allocator can
+    if (IsUsingDynamic()) {
+      data_ = Alloc().reallocate(data_, Capacity(), capacity);
+      SetCapacity(capacity);
+      return;
+    }
+  }
+  T *tmp = AllocateArray(capacity);
+  try {
+    RelocateRange(begin(), end(), tmp);
+  } catch (...) {
+    FreeArray(tmp, capacity);
+    throw;
+  }
+  if (IsUsingDynamic()) {
+    FreeArray(data_, Capacity());
+  }
+  data_ = tmp;
+  SetCapacity(capacity);
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+bool VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::MoveToStatic() noexcept {
+  try {
+    //on a throwing copy the built elements are destroyed, originals intact
+    RelocateRange(begin(), end(), StaticData());
+  } catch (...) {
+    return false;
+  }
+  FreeArray(data_, Capacity());
+  data_ = StaticData();
+  cur_cap_ = StaticCapacity;
+  return true;
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::StealFrom(
+    VLVector &other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+  if (other.IsUsingDynamic()) {
+    data_ = other.data_;
+    //capacity together with the Reserve() pin
+    cur_cap_ = other.cur_cap_;
+    other.data_ = other.StaticData();
+    other.cur_cap_ = StaticCapacity;
+  } else if constexpr (IsTriviallyRelocatable()) {
+    RelocateRange(other.begin(), other.end(), data_);
+  } else {
+    std::uninitialized_copy(std::make_move_iterator(other.begin()),
+                            std::make_move_iterator(other.end()), data_);
+    DestroyRange(other.begin(), other.end());
+  }
+  cur_size_ = other.cur_size_;
+  other.cur_size_ = 0;
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::MoveElementsFrom(VLVector &other) {
+  if (ShouldUseDynamic(other.cur_size_)) {
+    size_t new_capacity = CalculateCapacity(0, other.cur_size_);
+    data_ = AllocateArray(new_capacity);
+    SetCapacity(new_capacity);
+    VL_STATS_HOOK(Stats().RecordSpill());
+  }
+  if constexpr (IsTriviallyRelocatable()) {
+    RelocateRange(other.begin(), other.end(), data_);
+  } else {
+    std::uninitialized_copy(std::make_move_iterator(other.begin()),
+                            std::make_move_iterator(other.end()), data_);
+  }
+  cur_size_ = other.cur_size_;
+  other.Clear();
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::CopyElementsFrom(const VLVector &other) {
+  if (this->ShouldUseDynamic(other.cur_size_)) {
+    size_t new_capacity = CalculateCapacity(0, other.cur_size_);
+    data_ = AllocateArray(new_capacity);
+    SetCapacity(new_capacity);
+    VL_STATS_HOOK(Stats().RecordSpill());
+  }
+  //on a throwing copy ConstructRange destroys what it built, size stays 0
+  ConstructRange(other.cbegin(), other.cend(), this->begin());
+  cur_size_ = other.cur_size_;
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator, GrowthPolicy,
+         SizeType>::Swap(
+    VLVector &other) noexcept(std::is_nothrow_move_constructible<T>::value &&
+    std::is_nothrow_swappable<T>::value) {
+  if (this == &other) {
     return;
   }
-  size_t i = 0;
-  for (auto r_it = rbegin(); r_it != rend() - push_from; ++r_it) {
-    data_[cur_size_ - 1 - i + how_many] = *r_it;
-    i++;
+  if (IsUsingDynamic() && other.IsUsingDynamic()) {
+    std::swap(data_, other.data_);
+    std::swap(cur_cap_, other.cur_cap_);
+  } else if (!IsUsingDynamic() && !other.IsUsingDynamic()) {
+    //swap the common part, move the rest of the longer one across
+    VLVector &shorter = cur_size_ < other.cur_size_ ? *this : other;
+    VLVector &longer = cur_size_ < other.cur_size_ ? other : *this;
+    std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+    RelocateRange(longer.begin() + shorter.cur_size_, longer.end(),
+                  shorter.end());
+  } else {
+    //the static one's elements move into the other's unused static array
+    //and the dynamic array changes hands
+    VLVector &stat = IsUsingDynamic() ? other : *this;
+    VLVector &dyn = IsUsingDynamic() ? *this : other;
+    RelocateRange(stat.begin(), stat.end(), dyn.StaticData());
+    stat.data_ = dyn.data_;
+    stat.cur_cap_ = dyn.cur_cap_;
+    dyn.data_ = dyn.StaticData();
+    dyn.cur_cap_ = StaticCapacity;
+  }
+  std::swap(cur_size_, other.cur_size_);
+  if constexpr (AllocTraits::propagate_on_container_swap::value) {
+    using std::swap;
+    swap(Alloc(), other.Alloc());
   }
 }
+
+/**
+ * swaps the content of two vectors (see VLVector::Swap)
+ * @param lhs first vector
+ * @param rhs second vector
+ */
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+void swap(VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                   GrowthPolicy, SizeType> &lhs,
+          VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                   GrowthPolicy, SizeType> &rhs)
+noexcept(noexcept(lhs.Swap(rhs))) {
+  lhs.Swap(rhs);
+}
+
+template<typename T, size_t StaticCapacity, typename ShrinkPolicy,
+    typename Allocator, typename GrowthPolicy, typename SizeType>
+template<typename ForwardIterator>
+VL_CONSTEXPR20 void VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+              GrowthPolicy, SizeType>::InsertRange(
+    size_t index, ForwardIterator first, ForwardIterator last, size_t count) {
+  if constexpr (IsTriviallyRelocatable()) {
+    //realloc (or one memcpy out of the static array), one memmove of the
+    //tail and one copy of the new elements
+    if (cur_size_ + count > Capacity()) {
+      Reallocate(CalculateCapacity(cur_size_, count));
+    }
+    T *pos = begin() + index;
+    MoveCells(pos, end(), pos + count);
+    ConstructRange(first, last, pos);
+    cur_size_ += count;
+    return;
+  }
+  //'>' and not '>=': an exact fit in the static array must stay static
+  if (cur_size_ + count > Capacity()) {
+    size_t new_cap = CalculateCapacity(cur_size_, count);
+    VL_STATS_HOOK(Stats().RecordExpansion(!IsUsingDynamic(),
+                                          cur_size_ * sizeof(T)));
+    T *tmp = AllocateArray(new_cap);
+    T *built = tmp;
+    try {
+      ConstructRange(first, last, tmp + index);
+      try {
+        built = std::uninitialized_copy(MoveIfNoexcept(begin()),
+                                        MoveIfNoexcept(begin() + index), tmp);
+        std::uninitialized_copy(MoveIfNoexcept(begin() + index),
+                                MoveIfNoexcept(end()), tmp + index + count);
+      } catch (...) {
+        DestroyRange(tmp, built);
+        DestroyRange(tmp + index, tmp + index + count);
+        throw;
+      }
+    } catch (...) {
+      FreeArray(tmp, new_cap);
+      throw;
+    }
+    DestroyRange(begin(), end());
+    if (IsUsingDynamic()) {
+      FreeArray(data_, Capacity());
+    }
+    data_ = tmp;
+    SetCapacity(new_cap);
+    cur_size_ += count;
+    return;
+  }
+  //in place: cur_size_ always covers exactly the constructed cells
+  T *pos = begin() + index;
+  T *old_end = end();
+  size_t tail = cur_size_ - index;
+  if (tail > count) {
+    //the last 'count' elements move into raw cells, the rest shift in place
+    std::uninitialized_copy(std::make_move_iterator(old_end - count),
+                            std::make_move_iterator(old_end), old_end);
+    cur_size_ += count;
+    std::move_backward(pos, old_end - count, old_end);
+    std::copy(first, last, pos);
+  } else {
+    //the new elements past the old end are constructed, the tail moves
+    //into raw cells and the rest of the new elements are assigned
+    ForwardIterator mid = std::next(first, tail);
+    std::uninitialized_copy(mid, last, old_end);
+    cur_size_ += count - tail;
+    std::uninitialized_copy(std::make_move_iterator(pos),
+                            std::make_move_iterator(old_end), pos + count);
+    cur_size_ += tail;
+    std::copy(first, mid, pos);
+  }
+}
+
+/**
+ * CompactVLVector VLVector with 32 bit size and capacity: one pointer and two
+ * 32 bit counters (16 bytes) on top of the static array, for containers
+ * kept by the millions. holds up to 2^31 - 1 elements
+ */
+template<typename T, size_t StaticCapacity = DEFAULT_STATIC_CAPACITY,
+    typename ShrinkPolicy = ShrinkHysteresis<>,
+    typename Allocator = VLVectorAllocator<T>,
+    typename GrowthPolicy = DEFAULT_GROWTH_POLICY>
+using CompactVLVector = VLVector<T, StaticCapacity, ShrinkPolicy, Allocator,
+                                 GrowthPolicy, uint32_t>;
+
+#if __has_include(<memory_resource>)
+/**
+ * PmrVLVector VLVector whose dynamic array comes from a
+ * std::pmr::memory_resource (e.g. a per-request arena)
+ */
+template<typename T, size_t StaticCapacity = DEFAULT_STATIC_CAPACITY,
+    typename ShrinkPolicy = ShrinkHysteresis<>,
+    typename GrowthPolicy = DEFAULT_GROWTH_POLICY>
+using PmrVLVector = VLVector<T, StaticCapacity, ShrinkPolicy,
+                             std::pmr::polymorphic_allocator<T>,
+                             GrowthPolicy>;
+#endif
+
 #endif //EX6__VL_VECTOR_H_
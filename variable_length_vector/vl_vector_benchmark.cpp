@@ -0,0 +1,471 @@
+
+#include "vl_vector.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * BENCH_STATIC_CAPACITY static capacity of the benchmarked vectors
+ */
+#define BENCH_STATIC_CAPACITY 16
+
+/**
+ * BENCH_REPEATS every measurement is the best of this many runs
+ */
+#define BENCH_REPEATS 5
+
+/**
+ * BENCH_TARGET_WORK element moves aimed for in one container benchmark run
+ * (the amount of vectors in a run is chosen from it)
+ */
+#define BENCH_TARGET_WORK 2000000
+
+/**
+ * BENCH_MAX_BATCH maximal amount of vectors alive in one run
+ */
+#define BENCH_MAX_BATCH 20000
+
+/**
+ * allocation counters of CountingAllocator and StdCountingAllocator
+ */
+static size_t allocations = 0;
+static size_t reallocations = 0;
+
+/**
+ * CountingAllocator VLVectorAllocator that counts allocate/reallocate calls
+ * @tparam T elements type
+ */
+template<typename T>
+struct CountingAllocator : VLVectorAllocator<T> {
+  template<typename U>
+  struct rebind {
+    typedef CountingAllocator<U> other;
+  };
+
+  CountingAllocator() noexcept = default;
+
+  template<typename U>
+  CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    allocations++;
+    return VLVectorAllocator<T>::allocate(n);
+  }
+
+  template<typename U = T, typename = decltype(
+      std::declval<VLVectorAllocator<U> &>().reallocate(nullptr, 0, 0))>
+  T *reallocate(T *arr, size_t old_n, size_t new_n) {
+    reallocations++;
+    return VLVectorAllocator<T>::reallocate(arr, old_n, new_n);
+  }
+};
+
+/**
+ * StdCountingAllocator std::allocator that counts allocate calls (for
+ * std::vector)
+ * @tparam T elements type
+ */
+template<typename T>
+struct StdCountingAllocator : std::allocator<T> {
+  template<typename U>
+  struct rebind {
+    typedef StdCountingAllocator<U> other;
+  };
+
+  StdCountingAllocator() noexcept = default;
+
+  template<typename U>
+  StdCountingAllocator(const StdCountingAllocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    allocations++;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+/**
+ * BenchResult result of one workload for one growth policy
+ */
+struct BenchResult {
+  double ns_per_op;
+  size_t allocations;
+  size_t reallocations;
+  double capacity_ratio;
+};
+
+/**
+ * pushes n elements made by make(i) into a fresh vector
+ * @tparam Growth growth policy to measure
+ * @param n amount of elements
+ * @param make element factory
+ * @return best time per push, allocation counters and final
+ * capacity / size
+ */
+template<typename Growth, typename T, typename Make>
+BenchResult PushBackWorkload(size_t n, Make make) {
+  BenchResult result{1e300, 0, 0, 0};
+  for (int repeat = 0; repeat < BENCH_REPEATS; ++repeat) {
+    allocations = 0;
+    reallocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    VLVector<T, BENCH_STATIC_CAPACITY, ShrinkHysteresis<>,
+             CountingAllocator<T>, Growth> vec;
+    for (size_t i = 0; i < n; ++i) {
+      vec.PushBack(make(i));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    if (ns / n < result.ns_per_op) {
+      result.ns_per_op = ns / n;
+    }
+    result.allocations = allocations;
+    result.reallocations = reallocations;
+    result.capacity_ratio = double(vec.Capacity()) / vec.Size();
+  }
+  return result;
+}
+
+/**
+ * prints one row of the results table
+ * @param policy name of the growth policy
+ * @param result measured result
+ */
+static void PrintRow(const char *policy, const BenchResult &result) {
+  std::printf("  %-16s %10.2f %8zu %8zu %10.3f\n", policy, result.ns_per_op,
+              result.allocations, result.reallocations,
+              result.capacity_ratio);
+}
+
+/**
+ * runs a workload for every growth policy and prints a table
+ * @param title workload name
+ * @param n amount of elements pushed
+ * @param make element factory
+ */
+template<typename T, typename Make>
+static void RunWorkload(const char *title, size_t n, Make make) {
+  std::printf("%s, n = %zu\n", title, n);
+  std::printf("  %-16s %10s %8s %8s %10s\n", "policy", "ns/push", "allocs",
+              "reallocs", "cap/size");
+  PrintRow("GrowOneAndHalf", PushBackWorkload<GrowOneAndHalf, T>(n, make));
+  PrintRow("GrowDouble", PushBackWorkload<GrowDouble, T>(n, make));
+  PrintRow("GrowPowerOfTwo", PushBackWorkload<GrowPowerOfTwo, T>(n, make));
+  PrintRow("GrowSizeClass", PushBackWorkload<GrowSizeClass, T>(n, make));
+  std::printf("\n");
+}
+
+/**
+ * compares the growth policies
+ */
+static void RunGrowthBenchmarks() {
+  for (size_t n : {size_t(100), size_t(10000), size_t(1000000),
+                   size_t(10000000)}) {
+    RunWorkload<int>("PushBack int", n, [](size_t i) { return int(i); });
+  }
+  for (size_t n : {size_t(100), size_t(10000), size_t(1000000)}) {
+    RunWorkload<std::string>("PushBack std::string", n, [](size_t i) {
+      return std::string(24, char('a' + i % 26));
+    });
+  }
+}
+
+//______________________VLVector vs std::vector______________________________
+
+/**
+ * Blob32 32 bytes trivially copyable element
+ */
+struct Blob32 {
+  int values[8];
+};
+
+/**
+ * @param i element number
+ * @return element number i of type T
+ */
+template<typename T>
+T MakeElem(size_t i);
+
+template<>
+int MakeElem<int>(size_t i) { return int(i); }
+
+template<>
+Blob32 MakeElem<Blob32>(size_t i) {
+  Blob32 blob{};
+  blob.values[0] = int(i);
+  return blob;
+}
+
+template<>
+std::string MakeElem<std::string>(size_t i) {
+  //short enough for the small string optimization: no allocation of its own
+  return std::string(12, char('a' + i % 26));
+}
+
+/**
+ * @param elem element
+ * @return a number depending on the element (keeps iteration from being
+ * optimized away)
+ */
+static size_t Touch(int elem) { return size_t(elem); }
+static size_t Touch(const Blob32 &elem) { return size_t(elem.values[0]); }
+static size_t Touch(const std::string &elem) { return elem.size(); }
+
+/**
+ * VLOps VLVector operations used by the container benchmarks
+ */
+struct VLOps {
+  template<typename Vec, typename T>
+  static void Push(Vec &vec, const T &elem) { vec.PushBack(elem); }
+
+  template<typename Vec, typename T>
+  static void Insert(Vec &vec, size_t index, const T &elem) {
+    vec.Insert(vec.begin() + index, elem);
+  }
+
+  template<typename Vec>
+  static void Erase(Vec &vec, size_t first, size_t last) {
+    vec.Erase(vec.begin() + first, vec.begin() + last);
+  }
+
+  template<typename Vec>
+  static size_t Size(const Vec &vec) { return vec.Size(); }
+};
+
+/**
+ * StdOps std::vector operations used by the container benchmarks
+ */
+struct StdOps {
+  template<typename Vec, typename T>
+  static void Push(Vec &vec, const T &elem) { vec.push_back(elem); }
+
+  template<typename Vec, typename T>
+  static void Insert(Vec &vec, size_t index, const T &elem) {
+    vec.insert(vec.begin() + index, elem);
+  }
+
+  template<typename Vec>
+  static void Erase(Vec &vec, size_t first, size_t last) {
+    vec.erase(vec.begin() + first, vec.begin() + last);
+  }
+
+  template<typename Vec>
+  static size_t Size(const Vec &vec) { return vec.size(); }
+};
+
+/**
+ * Workload container operation measured
+ * PUSH_BACK- n PushBacks into an empty vector
+ * INSERT_FRONT- n Inserts at begin() into an empty vector
+ * INSERT_MIDDLE- n Inserts at the middle into an empty vector
+ * ERASE_RANGE- one Erase of the middle half of an n elements vector
+ * COPY- one copy of an n elements vector
+ * ITERATE- one pass over an n elements vector (per element)
+ */
+enum Workload {
+  PUSH_BACK, INSERT_FRONT, INSERT_MIDDLE, ERASE_RANGE, COPY, ITERATE
+};
+
+/**
+ * @param workload workload
+ * @return its name
+ */
+static const char *WorkloadName(Workload workload) {
+  static const char *names[] = {"PushBack", "InsertFront", "InsertMiddle",
+                                "EraseRange", "Copy", "Iterate"};
+  return names[workload];
+}
+
+/**
+ * ContainerResult result of one workload for one container
+ */
+struct ContainerResult {
+  double ns_per_op;
+  double allocs_per_op;
+  long peak_rss_kb;
+};
+
+/**
+ * @param field "VmRSS:" or "VmHWM:"
+ * @return the field of /proc/self/status in KB, -1 if not available
+ */
+static long ReadStatusKb(const char *field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  size_t length = std::strlen(field);
+  while (std::getline(status, line)) {
+    if (line.compare(0, length, field) == 0) {
+      return std::atol(line.c_str() + length);
+    }
+  }
+  return -1;
+}
+
+/**
+ * resets the peak RSS of the process to its current RSS (linux >= 4.0)
+ * @return current RSS in KB, -1 if the peak can't be reset
+ */
+static long ResetPeakRss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if (!(clear_refs << "5" << std::flush)) {
+    return -1;
+  }
+  return ReadStatusKb("VmRSS:");
+}
+
+/**
+ * runs one workload over a batch of vectors, best of BENCH_REPEATS
+ * @tparam Vec container type
+ * @tparam Ops its operations (VLOps, StdOps)
+ * @tparam T elements type
+ * @param workload operation to measure
+ * @param n vector size
+ * @return time and allocations per operation, peak RSS above the start
+ */
+template<typename Vec, typename Ops, typename T>
+ContainerResult RunContainer(Workload workload, size_t n) {
+  size_t work = n;
+  if (workload == INSERT_FRONT || workload == INSERT_MIDDLE) {
+    work = n * n / 2 + n;
+  }
+  size_t batch = BENCH_TARGET_WORK / (work == 0 ? 1 : work);
+  batch = batch == 0 ? 1 : (batch > BENCH_MAX_BATCH ? BENCH_MAX_BATCH : batch);
+  //operations counted per measurement
+  size_t ops = batch;
+  if (workload == PUSH_BACK || workload == INSERT_FRONT ||
+      workload == INSERT_MIDDLE || workload == ITERATE) {
+    ops = batch * n;
+  }
+  std::vector<T> elems;
+  for (size_t i = 0; i < n; ++i) {
+    elems.push_back(MakeElem<T>(i));
+  }
+  ContainerResult result{1e300, 0, 0};
+  size_t sink = 0;
+  for (int repeat = 0; repeat < BENCH_REPEATS; ++repeat) {
+    std::vector<Vec> vecs(batch);
+    std::vector<Vec> copies;
+    if (workload == ERASE_RANGE || workload == COPY || workload == ITERATE) {
+      for (Vec &vec : vecs) {
+        for (const T &elem : elems) {
+          Ops::Push(vec, elem);
+        }
+      }
+    }
+    if (workload == COPY) {
+      copies.reserve(batch);
+    }
+    long rss_before = ResetPeakRss();
+    allocations = 0;
+    reallocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (Vec &vec : vecs) {
+      switch (workload) {
+        case PUSH_BACK:
+          for (const T &elem : elems) {
+            Ops::Push(vec, elem);
+          }
+          break;
+        case INSERT_FRONT:
+          for (const T &elem : elems) {
+            Ops::Insert(vec, 0, elem);
+          }
+          break;
+        case INSERT_MIDDLE:
+          for (const T &elem : elems) {
+            Ops::Insert(vec, Ops::Size(vec) / 2, elem);
+          }
+          break;
+        case ERASE_RANGE:
+          Ops::Erase(vec, n / 4, n - n / 4);
+          break;
+        case COPY:
+          copies.push_back(vec);
+          break;
+        case ITERATE:
+          for (const T &elem : vec) {
+            sink += Touch(elem);
+          }
+          break;
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    if (ns / ops < result.ns_per_op) {
+      result.ns_per_op = ns / ops;
+    }
+    result.allocs_per_op = double(allocations + reallocations) / ops;
+    long peak = ReadStatusKb("VmHWM:");
+    result.peak_rss_kb = rss_before < 0 || peak < 0 ? -1 : peak - rss_before;
+  }
+  if (sink == 1) {
+    std::printf(" ");
+  }
+  return result;
+}
+
+/**
+ * runs one workload for VLVector and std::vector and prints their rows
+ * @tparam T elements type
+ * @param type_name name of T
+ * @param workload operation to measure
+ * @param n vector size
+ */
+template<typename T>
+static void CompareContainers(const char *type_name, Workload workload,
+                              size_t n) {
+  typedef VLVector<T, BENCH_STATIC_CAPACITY, ShrinkHysteresis<>,
+                   CountingAllocator<T>> BenchVLVector;
+  typedef std::vector<T, StdCountingAllocator<T>> BenchStdVector;
+  ContainerResult vl = RunContainer<BenchVLVector, VLOps, T>(workload, n);
+  ContainerResult std_vec = RunContainer<BenchStdVector, StdOps, T>(workload,
+                                                                    n);
+  std::printf("%-12s %-12s %6zu %10.2f %10.2f %9.3f %10.3f %9ld %9ld\n",
+              WorkloadName(workload), type_name, n, vl.ns_per_op,
+              std_vec.ns_per_op, vl.allocs_per_op, std_vec.allocs_per_op,
+              vl.peak_rss_kb, std_vec.peak_rss_kb);
+}
+
+/**
+ * compares VLVector to std::vector for every workload, element type and
+ * size (sizes straddle BENCH_STATIC_CAPACITY)
+ */
+static void RunContainerBenchmarks() {
+  std::printf("VLVector<T, %d> vs std::vector<T> (per op: ns, allocations; "
+              "peak RSS above start, KB)\n", BENCH_STATIC_CAPACITY);
+  std::printf("%-12s %-12s %6s %10s %10s %9s %10s %9s %9s\n", "workload",
+              "type", "n", "vl ns", "std ns", "vl allocs", "std allocs",
+              "vl KB", "std KB");
+  const size_t sizes[] = {4, BENCH_STATIC_CAPACITY - 1, BENCH_STATIC_CAPACITY,
+                          BENCH_STATIC_CAPACITY + 1, 4 * BENCH_STATIC_CAPACITY,
+                          1024};
+  for (int w = PUSH_BACK; w <= ITERATE; ++w) {
+    Workload workload = Workload(w);
+    for (size_t n : sizes) {
+      CompareContainers<int>("int", workload, n);
+      CompareContainers<Blob32>("Blob32", workload, n);
+      CompareContainers<std::string>("std::string", workload, n);
+    }
+  }
+}
+
+/**
+ * runs the benchmarks
+ * @param argc amount of arguments
+ * @param argv "growth" (growth policies), "containers" (VLVector vs
+ * std::vector), nothing for both
+ */
+int main(int argc, char *argv[]) {
+  bool all = argc < 2;
+  if (all || std::strcmp(argv[1], "growth") == 0) {
+    RunGrowthBenchmarks();
+  }
+  if (all || std::strcmp(argv[1], "containers") == 0) {
+    RunContainerBenchmarks();
+  }
+  return 0;
+}
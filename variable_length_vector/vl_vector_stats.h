@@ -0,0 +1,192 @@
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <typeinfo>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+/**
+ * VL_STATS_FILE_ENV environment variable naming the file the stats are
+ * appended to at exit (stderr if unset)
+ */
+#define VL_STATS_FILE_ENV "VL_VECTOR_STATS_FILE"
+
+#ifndef EX6__VL_VECTOR_STATS_H_
+#define EX6__VL_VECTOR_STATS_H_
+
+/**
+ * VLVectorStats counters of all VLVectors with the same element type and
+ * StaticCapacity (whatever their policies), collected when vl_vector.h is
+ * built with VL_VECTOR_STATS defined. updated with relaxed atomics, so
+ * vectors on different threads may share them
+ */
+struct VLVectorStats {
+  const char *type_name;
+  size_t static_capacity;
+  size_t elem_size;
+  //moves from static_arr_ to a dynamic array (growth past StaticCapacity,
+  //or a vector constructed/copied straight into a dynamic array)
+  std::atomic<uint64_t> spills;
+  //growth reallocations (ExpandDataArray, Insert and Reserve growth)
+  std::atomic<uint64_t> expansions;
+  //bytes of elements carried over to the new array by the expansions
+  std::atomic<uint64_t> bytes_copied;
+  //moves back to static_arr_ after PopBack/Erase (see the shrink policy)
+  std::atomic<uint64_t> shrink_backs;
+  //largest size any of the vectors reached
+  std::atomic<uint64_t> high_water;
+  //next registered stats (see VLVectorStatsList)
+  VLVectorStats *next;
+
+  /**
+   * Constructor- all counters zero
+   * @param type name of the element type
+   * @param capacity StaticCapacity of the vectors
+   * @param size sizeof the element type
+   */
+  VLVectorStats(const char *type, size_t capacity, size_t size) noexcept
+      : type_name(type), static_capacity(capacity), elem_size(size),
+        spills(0), expansions(0), bytes_copied(0), shrink_backs(0),
+        high_water(0), next(nullptr) {}
+
+  /**
+   * records a vector moving from static_arr_ to a dynamic array
+   */
+  void RecordSpill() noexcept {
+    spills.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * records a growth reallocation
+   * @param was_static true if the elements were in static_arr_
+   * @param bytes bytes of elements moved to the new array
+   */
+  void RecordExpansion(bool was_static, size_t bytes) noexcept {
+    if (was_static) {
+      RecordSpill();
+    }
+    expansions.fetch_add(1, std::memory_order_relaxed);
+    bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /**
+   * records a vector moving back to static_arr_
+   */
+  void RecordShrinkBack() noexcept {
+    shrink_backs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * records the size a vector grew to
+   * @param size size after the addition
+   */
+  void RecordSize(size_t size) noexcept {
+    uint64_t seen = high_water.load(std::memory_order_relaxed);
+    while (size > seen && !high_water.compare_exchange_weak(
+        seen, size, std::memory_order_relaxed)) {
+    }
+  }
+};
+
+//stays valid during exit: atexit handlers may run after the stats' lifetime
+static_assert(std::is_trivially_destructible<VLVectorStats>::value,
+              "VLVectorStats must be trivially destructible");
+
+/**
+ * @return head of the list of all stats registered so far (newest first,
+ * linked through VLVectorStats::next)
+ */
+inline std::atomic<VLVectorStats *> &VLVectorStatsList() noexcept {
+  static std::atomic<VLVectorStats *> head(nullptr);
+  return head;
+}
+
+/**
+ * prints one line per registered element type/StaticCapacity
+ * @param out stream to print to
+ */
+inline void DumpVLVectorStats(std::FILE *out) noexcept {
+  std::fprintf(out, "VLVector stats: type, static capacity, sizeof, spills, "
+                    "expansions, bytes copied, shrink backs, high water\n");
+  for (const VLVectorStats *stats =
+      VLVectorStatsList().load(std::memory_order_acquire);
+       stats != nullptr; stats = stats->next) {
+    std::fprintf(out, "%s, %zu, %zu, %llu, %llu, %llu, %llu, %llu\n",
+                 stats->type_name, stats->static_capacity, stats->elem_size,
+                 (unsigned long long) stats->spills.load(),
+                 (unsigned long long) stats->expansions.load(),
+                 (unsigned long long) stats->bytes_copied.load(),
+                 (unsigned long long) stats->shrink_backs.load(),
+                 (unsigned long long) stats->high_water.load());
+  }
+}
+
+/**
+ * atexit handler: dumps the stats to the file named by VL_STATS_FILE_ENV, or
+ * to stderr
+ */
+inline void DumpVLVectorStatsAtExit() noexcept {
+  const char *path = std::getenv(VL_STATS_FILE_ENV);
+  std::FILE *file = path != nullptr ? std::fopen(path, "a") : nullptr;
+  DumpVLVectorStats(file != nullptr ? file : stderr);
+  if (file != nullptr) {
+    std::fclose(file);
+  }
+}
+
+/**
+ * @return readable name of T (demangled when the ABI allows it; the string
+ * is kept for the whole run)
+ */
+template<typename T>
+const char *VLVectorStatsTypeName() noexcept {
+  const char *name = typeid(T).name();
+#if __has_include(<cxxabi.h>)
+  int status = 0;
+  char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status == 0 && demangled != nullptr) {
+    return demangled;
+  }
+#endif
+  return name;
+}
+
+/**
+ * registers new stats in VLVectorStatsList. the first registration installs
+ * the dump at exit
+ * @param stats stats to register
+ * @return stats
+ */
+inline VLVectorStats &RegisterVLVectorStats(VLVectorStats &stats) noexcept {
+  std::atomic<VLVectorStats *> &head = VLVectorStatsList();
+  VLVectorStats *old_head = head.load(std::memory_order_relaxed);
+  do {
+    stats.next = old_head;
+  } while (!head.compare_exchange_weak(old_head, &stats,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed));
+  if (old_head == nullptr) {
+    std::atexit(DumpVLVectorStatsAtExit);
+  }
+  return stats;
+}
+
+/**
+ * @tparam T elements type
+ * @tparam StaticCapacity static capacity of the vectors
+ * @return the stats shared by all VLVector<T, StaticCapacity, ...>
+ */
+template<typename T, size_t StaticCapacity>
+VLVectorStats &VLVectorStatsFor() noexcept {
+  static VLVectorStats stats(VLVectorStatsTypeName<T>(), StaticCapacity,
+                             sizeof(T));
+  static VLVectorStats &registered = RegisterVLVectorStats(stats);
+  return registered;
+}
+
+#endif //EX6__VL_VECTOR_STATS_H_
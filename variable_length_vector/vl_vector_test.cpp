@@ -0,0 +1,1188 @@
+#include "vl_vector.h"
+#include "flat_vl_map.h"
+#include "concurrent_vl_vector.h"
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * TEST_STATIC_CAPACITY static capacity of the tested vectors (small, so the
+ * random operations cross between the static and the dynamic array often)
+ */
+#define TEST_STATIC_CAPACITY 4
+
+/**
+ * DIFFERENTIAL_STEPS random operations applied in a differential test
+ */
+#define DIFFERENTIAL_STEPS 20000
+
+/**
+ * SEARCH_MAX_SIZE search results are compared for every size up to this
+ * one (covers every SIMD tail length)
+ */
+#define SEARCH_MAX_SIZE 300
+
+/**
+ * SEARCH_LONG_SIZE and a size long enough for the per lane counters of 8
+ * bit elements to be flushed many times (see SIMD_COUNT_FLUSH)
+ */
+#define SEARCH_LONG_SIZE 20000
+
+/**
+ * FLAT_STEPS random operations applied to the flat containers
+ */
+#define FLAT_STEPS 20000
+
+/**
+ * FLAT_KEY_RANGE keys of the flat containers tests are drawn from [0,
+ * FLAT_KEY_RANGE) (more than FLAT_BRANCHLESS_MAX_SIZE, so both searches
+ * run)
+ */
+#define FLAT_KEY_RANGE 150
+
+/**
+ * CONCURRENT_WRITERS threads appending to a ConcurrentVLVector at once
+ */
+#define CONCURRENT_WRITERS 8
+
+/**
+ * CONCURRENT_APPENDS elements appended by each writer thread
+ */
+#define CONCURRENT_APPENDS 20000
+
+/**
+ * DIFFERENTIAL_MAX_SIZE vectors are cleared when they grow past this size
+ */
+#define DIFFERENTIAL_MAX_SIZE 64
+
+
+enum Failures {SUCCESS, TEST1FAIL, TEST2FAIL, TEST3FAIL, TEST4FAIL, TEST5FAIL,
+    TEST6FAIL, TEST7FAIL, TEST8FAIL, TEST9FAIL};
+
+int Test1();
+int Test2();
+int Test3();
+int Test4();
+int Test5();
+int Test6();
+int Test7();
+int Test8();
+int Test9();
+
+/**
+ * runs one test and prints its result
+ * @param number test number
+ * @param title what the test covers
+ * @param test the test
+ * @return the test's result
+ */
+static int RunTest(int number, const char *title, int (*test)()) {
+  std::cout << "Test " << number << ": " << title << std::endl;
+  int result = test();
+  if (result != SUCCESS) {
+    std::cout << "TEST " << number << " FAILED!" << std::endl << std::endl;
+    return result;
+  }
+  std::cout << "TEST " << number << " PASSED!" << std::endl << std::endl;
+  return SUCCESS;
+}
+
+int main() {
+  int result = RunTest(1, "differential against std::vector", Test1);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(2, "PushBack/Insert of the vector's own elements", Test2);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(3, "shrink policies, Reserve and ShrinkToFit", Test3);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(4, "PMR allocator propagation", Test4);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(5, "constexpr static array path", Test5);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(6, "Find/Count/MinElement/MaxElement", Test6);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(7, "FlatVLSet bulk Insert when a copy throws", Test7);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(8, "FlatVLSet and FlatVLMap against std::set and "
+                      "std::map", Test8);
+  if (result != SUCCESS) {
+    return result;
+  }
+  result = RunTest(9, "ConcurrentVLVector appends from many threads", Test9);
+  if (result != SUCCESS) {
+    return result;
+  }
+  std::cout << "ALL TESTS PASSED" << std::endl;
+  return SUCCESS;
+}
+
+/**
+ * amount of Tracked objects alive (leaks and double destructions show up as
+ * a non zero count after a test)
+ */
+static long tracked_alive = 0;
+
+/**
+ * Tracked non trivial element that counts its live instances
+ */
+struct Tracked {
+  int value;
+
+  explicit Tracked(int v = 0) : value(v) { ++tracked_alive; }
+
+  Tracked(const Tracked &other) : value(other.value) { ++tracked_alive; }
+
+  Tracked(Tracked &&other) noexcept : value(other.value) {
+    other.value = -1;
+    ++tracked_alive;
+  }
+
+  Tracked &operator=(const Tracked &other) = default;
+
+  Tracked &operator=(Tracked &&other) noexcept {
+    value = other.value;
+    other.value = -1;
+    return *this;
+  }
+
+  ~Tracked() { --tracked_alive; }
+
+  bool operator==(const Tracked &other) const { return value == other.value; }
+
+  bool operator!=(const Tracked &other) const { return value != other.value; }
+
+  bool operator<(const Tracked &other) const { return value < other.value; }
+};
+
+/**
+ * MoveOnly element that can only be moved
+ */
+struct MoveOnly {
+  std::unique_ptr<int> value;
+
+  explicit MoveOnly(int v) : value(new int(v)) {}
+};
+
+/**
+ * NoDefault element without a default constructor (with a heap allocated
+ * member, so lost or doubled elements show up under a sanitizer)
+ */
+struct NoDefault {
+  std::string value;
+
+  NoDefault() = delete;
+
+  explicit NoDefault(int v)
+      : value("element number " + std::to_string(v)) {}
+};
+
+/**
+ * @return the value an element was made from
+ */
+static int ValueOf(int elem) { return elem; }
+static int ValueOf(const Tracked &elem) { return elem.value; }
+static int ValueOf(const MoveOnly &elem) { return *elem.value; }
+static int ValueOf(const NoDefault &elem) {
+  return std::stoi(elem.value.substr(elem.value.rfind(' ') + 1));
+}
+
+/**
+ * @return an element made from value
+ */
+template<typename T>
+static T Make(int value) { return T(value); }
+
+/**
+ * next number of a linear congruential generator (the tests must be
+ * reproducible)
+ * @param state generator state
+ * @return number in [0, 2^31)
+ */
+static unsigned Next(unsigned long long &state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return unsigned(state >> 33);
+}
+
+/**
+ * @return true if vec holds the same values as expected, in the same order
+ */
+template<typename Vec, typename T>
+static bool SameElements(const Vec &vec, const std::vector<T> &expected) {
+  if (vec.Size() != expected.size() || vec.Empty() != expected.empty() ||
+      vec.Capacity() < vec.Size()) {
+    return false;
+  }
+  size_t index = 0;
+  for (auto it = vec.begin(); it != vec.end(); ++it, ++index) {
+    if (ValueOf(*it) != ValueOf(expected[index])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * applies the same random operations to a VLVector and a std::vector and
+ * compares them after each one. copying operations are only used if T is
+ * copy constructible
+ * @tparam Vec VLVector type of elements T
+ * @tparam T elements type
+ * @param seed generator seed
+ * @return true if the vectors never differed
+ */
+template<typename Vec, typename T>
+static bool Differential(unsigned long long seed) {
+  Vec vec;
+  std::vector<T> expected;
+  int next_value = 0;
+  for (int step = 0; step < DIFFERENTIAL_STEPS; ++step) {
+    size_t size = expected.size();
+    size_t pos = size == 0 ? 0 : Next(seed) % (size + 1);
+    switch (Next(seed) % 9) {
+      case 0:
+        vec.PushBack(Make<T>(next_value));
+        expected.push_back(Make<T>(next_value++));
+        break;
+      case 1:
+        vec.EmplaceBack(next_value);
+        expected.emplace_back(next_value++);
+        break;
+      case 2:
+        vec.Insert(vec.cbegin() + pos, Make<T>(next_value));
+        expected.insert(expected.begin() + pos, Make<T>(next_value++));
+        break;
+      case 3:
+        vec.Emplace(vec.cbegin() + pos, next_value);
+        expected.emplace(expected.begin() + pos, next_value++);
+        break;
+      case 4:
+        if (pos < size) {
+          vec.Erase(vec.cbegin() + pos);
+          expected.erase(expected.begin() + pos);
+        }
+        break;
+      case 5: {
+        size_t last = pos + Next(seed) % (size - pos + 1);
+        vec.Erase(vec.cbegin() + pos, vec.cbegin() + last);
+        expected.erase(expected.begin() + pos, expected.begin() + last);
+        break;
+      }
+      case 6:
+        vec.PopBack();
+        if (!expected.empty()) {
+          expected.pop_back();
+        }
+        break;
+      case 7:
+        if constexpr (std::is_copy_constructible<T>::value) {
+          std::vector<T> range;
+          size_t count = Next(seed) % (2 * TEST_STATIC_CAPACITY);
+          for (size_t i = 0; i < count; ++i) {
+            range.push_back(Make<T>(next_value++));
+          }
+          vec.Insert(vec.cbegin() + pos, range.begin(), range.end());
+          expected.insert(expected.begin() + pos, range.begin(), range.end());
+        }
+        break;
+      default: {
+        //through a copy or a move of the whole vector
+        if constexpr (std::is_copy_constructible<T>::value) {
+          Vec copy(vec);
+          if (!SameElements(copy, expected)) {
+            return false;
+          }
+          vec = copy;
+        }
+        Vec moved(std::move(vec));
+        if (!vec.Empty() || !SameElements(moved, expected)) {
+          return false;
+        }
+        vec = std::move(moved);
+        break;
+      }
+    }
+    if (expected.size() > DIFFERENTIAL_MAX_SIZE) {
+      vec.Clear();
+      expected.clear();
+    }
+    if (!SameElements(vec, expected)) {
+      std::cerr << "differs after step " << step << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * runs the differential test on T with every shrink policy
+ * @tparam T elements type
+ * @return true if it passed
+ */
+template<typename T>
+static bool DifferentialAllPolicies() {
+  return Differential<VLVector<T, TEST_STATIC_CAPACITY>, T>(1) &&
+      Differential<VLVector<T, TEST_STATIC_CAPACITY, ShrinkNever>, T>(2) &&
+      Differential<VLVector<T, TEST_STATIC_CAPACITY, ShrinkImmediately>,
+                   T>(3) &&
+      Differential<CompactVLVector<T, TEST_STATIC_CAPACITY>, T>(4);
+}
+
+/**
+ * pushes and inserts elements of a vector into itself, at capacity (the
+ * reference would dangle if the array were freed first) and with room
+ * (the element would be shifted under the reference)
+ * @tparam T copyable elements type
+ * @return true if the vector matches std::vector
+ */
+template<typename T>
+static bool SelfReference() {
+  VLVector<T, TEST_STATIC_CAPACITY> vec;
+  std::vector<T> expected;
+  for (int i = 0; i < 3 * TEST_STATIC_CAPACITY; ++i) {
+    //at capacity: every few pushes grow the array
+    if (vec.Empty()) {
+      vec.PushBack(Make<T>(i));
+      expected.push_back(Make<T>(i));
+      continue;
+    }
+    vec.PushBack(vec[0]);
+    expected.push_back(expected[0]);
+    vec.Insert(vec.cbegin(), vec.Data()[vec.Size() - 1]);
+    expected.insert(expected.begin(), expected.back());
+    vec.Insert(vec.cbegin() + 1, std::move(vec.Data()[vec.Size() - 1]));
+    vec.PopBack();
+    T moved = std::move(expected.back());
+    expected.pop_back();
+    expected.insert(expected.begin() + 1, std::move(moved));
+    vec.EmplaceBack(vec.Data()[vec.Size() / 2]);
+    expected.emplace_back(expected[expected.size() / 2]);
+    vec.PushBack(Make<T>(i));
+    expected.push_back(Make<T>(i));
+    if (!SameElements(vec, expected)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Test1() {
+  if (!DifferentialAllPolicies<int>() ||
+      !DifferentialAllPolicies<Tracked>() ||
+      !DifferentialAllPolicies<MoveOnly>() ||
+      !DifferentialAllPolicies<NoDefault>()) {
+    return TEST1FAIL;
+  }
+  if (tracked_alive != 0) {
+    std::cerr << tracked_alive << " Tracked objects alive" << std::endl;
+    return TEST1FAIL;
+  }
+  return SUCCESS;
+}
+
+int Test2() {
+  if (!SelfReference<int>() || !SelfReference<Tracked>() ||
+      !SelfReference<NoDefault>()) {
+    return TEST2FAIL;
+  }
+  return tracked_alive == 0 ? SUCCESS : TEST2FAIL;
+}
+
+/**
+ * @return true if vec holds 0, 1, ..., Size() - 1
+ */
+template<typename Vec>
+static bool IsSequence(const Vec &vec) {
+  for (size_t i = 0; i < vec.Size(); ++i) {
+    if (vec.Data()[i] != int(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * pushes 0, 1, ..., count - 1
+ */
+template<typename Vec>
+static void Fill(Vec &vec, int count) {
+  for (int i = 0; i < count; ++i) {
+    vec.PushBack(i);
+  }
+}
+
+int Test3() {
+  const size_t static_cap = 2 * TEST_STATIC_CAPACITY;
+  //default ShrinkHysteresis<2>: back to static at StaticCapacity / 2
+  VLVector<int, 2 * TEST_STATIC_CAPACITY> hysteresis;
+  Fill(hysteresis, static_cap + 1);
+  if (hysteresis.Capacity() <= static_cap) {
+    return TEST3FAIL;
+  }
+  while (hysteresis.Size() > static_cap / 2 + 1) {
+    hysteresis.PopBack();
+  }
+  if (hysteresis.Capacity() <= static_cap) {
+    return TEST3FAIL;
+  }
+  hysteresis.PopBack();
+  if (hysteresis.Capacity() != static_cap || !IsSequence(hysteresis)) {
+    return TEST3FAIL;
+  }
+  //a range Erase goes through the same policy
+  Fill(hysteresis, static_cap);
+  hysteresis.Erase(hysteresis.cbegin() + 1, hysteresis.cend());
+  if (hysteresis.Capacity() != static_cap || hysteresis.Size() != 1) {
+    return TEST3FAIL;
+  }
+
+  VLVector<int, 2 * TEST_STATIC_CAPACITY, ShrinkImmediately> immediately;
+  Fill(immediately, static_cap + 1);
+  immediately.PopBack();
+  if (immediately.Capacity() != static_cap || !IsSequence(immediately)) {
+    return TEST3FAIL;
+  }
+
+  VLVector<int, 2 * TEST_STATIC_CAPACITY, ShrinkNever> never;
+  Fill(never, static_cap + 1);
+  never.Erase(never.cbegin(), never.cend());
+  if (never.Capacity() <= static_cap) {
+    return TEST3FAIL;
+  }
+  never.Clear();
+  if (never.Capacity() != static_cap) {
+    return TEST3FAIL;
+  }
+
+  //Reserve pins the capacity, ShrinkToFit and Clear unpin it
+  VLVector<int, 2 * TEST_STATIC_CAPACITY, ShrinkImmediately> pinned;
+  Fill(pinned, 2);
+  pinned.Reserve(static_cap);
+  if (pinned.Capacity() != static_cap) {
+    return TEST3FAIL;
+  }
+  pinned.Reserve(10 * static_cap);
+  size_t reserved = pinned.Capacity();
+  if (reserved < 10 * static_cap) {
+    return TEST3FAIL;
+  }
+  Fill(pinned, int(reserved) - 2);
+  if (pinned.Capacity() != reserved) {
+    return TEST3FAIL;
+  }
+  while (!pinned.Empty()) {
+    pinned.PopBack();
+  }
+  if (pinned.Capacity() != reserved) {
+    return TEST3FAIL;
+  }
+  Fill(pinned, static_cap + 3);
+  pinned.ShrinkToFit();
+  if (pinned.Capacity() != static_cap + 3 || !IsSequence(pinned)) {
+    return TEST3FAIL;
+  }
+  pinned.PopBack();
+  pinned.PopBack();
+  pinned.PopBack();
+  if (pinned.Capacity() != static_cap || !IsSequence(pinned)) {
+    return TEST3FAIL;
+  }
+  pinned.Reserve(reserved);
+  pinned.ShrinkToFit();
+  if (pinned.Capacity() != static_cap || !IsSequence(pinned)) {
+    return TEST3FAIL;
+  }
+  pinned.Reserve(reserved);
+  pinned.Clear();
+  Fill(pinned, static_cap + 1);
+  pinned.PopBack();
+  if (pinned.Capacity() != static_cap) {
+    return TEST3FAIL;
+  }
+
+  CompactVLVector<int, TEST_STATIC_CAPACITY> compact;
+  try {
+    compact.Reserve(size_t(1) << 31);
+    return TEST3FAIL;
+  } catch (const std::length_error &) {
+  }
+  return compact.Capacity() == TEST_STATIC_CAPACITY ? SUCCESS : TEST3FAIL;
+}
+
+#if __has_include(<memory_resource>)
+/**
+ * CountingResource memory resource that counts the blocks it handed out
+ * and not yet got back
+ */
+class CountingResource : public std::pmr::memory_resource {
+  size_t outstanding_ = 0;
+  size_t allocations_ = 0;
+
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    void *block = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    ++outstanding_;
+    ++allocations_;
+    return block;
+  }
+
+  void do_deallocate(void *block, size_t bytes, size_t alignment) override {
+    --outstanding_;
+    std::pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept
+  override {
+    return this == &other;
+  }
+
+ public:
+  /**
+   * @return amount of blocks not deallocated yet
+   */
+  size_t Outstanding() const noexcept { return outstanding_; }
+
+  /**
+   * @return amount of allocations so far
+   */
+  size_t Allocations() const noexcept { return allocations_; }
+};
+
+int Test4() {
+  typedef PmrVLVector<Tracked, TEST_STATIC_CAPACITY> Vec;
+  CountingResource first, second, third;
+  {
+    Vec vec(&first);
+    for (int i = 0; i < 4 * TEST_STATIC_CAPACITY; ++i) {
+      vec.EmplaceBack(i);
+    }
+    if (vec.GetAllocator().resource() != &first ||
+        first.Outstanding() != 1) {
+      return TEST4FAIL;
+    }
+    size_t first_allocations = first.Allocations();
+
+    //copy construction: select_on_container_copy_construction, i.e. the
+    //default resource
+    Vec copy(vec);
+    if (copy.GetAllocator().resource() != std::pmr::get_default_resource() ||
+        first.Allocations() != first_allocations || copy != vec) {
+      return TEST4FAIL;
+    }
+
+    //move construction takes the resource and the array along
+    Vec moved(std::move(vec));
+    if (moved.GetAllocator().resource() != &first ||
+        first.Allocations() != first_allocations || !vec.Empty() ||
+        moved != copy) {
+      return TEST4FAIL;
+    }
+
+    //assignments don't propagate: the target keeps its resource
+    Vec assigned(&second);
+    assigned = moved;
+    if (assigned.GetAllocator().resource() != &second ||
+        second.Outstanding() != 1 || assigned != copy) {
+      return TEST4FAIL;
+    }
+    Vec move_assigned(&third);
+    move_assigned = std::move(moved);
+    if (move_assigned.GetAllocator().resource() != &third ||
+        third.Outstanding() != 1 || move_assigned != copy) {
+      return TEST4FAIL;
+    }
+    //same resource: the array changes hands without allocating
+    Vec same(&third);
+    size_t third_allocations = third.Allocations();
+    same = std::move(move_assigned);
+    if (same.GetAllocator().resource() != &third ||
+        third.Allocations() != third_allocations || same != copy) {
+      return TEST4FAIL;
+    }
+  }
+  if (first.Outstanding() != 0 || second.Outstanding() != 0 ||
+      third.Outstanding() != 0 || tracked_alive != 0) {
+    return TEST4FAIL;
+  }
+  return SUCCESS;
+}
+#else
+int Test4() {
+  return SUCCESS;
+}
+#endif
+
+#if __cplusplus >= 202002L
+/**
+ * builds the squares of 0, ..., count - 1 and edits them with the
+ * operations allowed in constant evaluation
+ * @param count amount of squares (<= 2 * TEST_STATIC_CAPACITY - 1)
+ * @return the vector -1, 1, 4, ..., (count - 2)^2
+ */
+constexpr VLVector<int, 2 * TEST_STATIC_CAPACITY> Squares(int count) {
+  VLVector<int, 2 * TEST_STATIC_CAPACITY> squares;
+  for (int i = 0; i < count; ++i) {
+    squares.PushBack(i * i);
+  }
+  squares.Insert(squares.cbegin(), -1);
+  squares.Erase(squares.cbegin() + 1);
+  squares.PopBack();
+  return squares;
+}
+
+/**
+ * @return sum of the elements of Squares(count), through iterators
+ */
+constexpr int SumOfSquares(int count) {
+  VLVector<int, 2 * TEST_STATIC_CAPACITY> squares = Squares(count);
+  int sum = 0;
+  for (int square : squares) {
+    sum += square;
+  }
+  return sum;
+}
+
+/**
+ * @return true if Squares(6) has the expected elements, capacity and
+ * search results
+ */
+constexpr bool CheckSquares() {
+  VLVector<int, 2 * TEST_STATIC_CAPACITY> squares = Squares(6);
+  return squares.Size() == 5 && squares[0] == -1 && squares[4] == 16 &&
+      squares.Capacity() == 2 * TEST_STATIC_CAPACITY &&
+      squares.Contains(9) && !squares.Contains(25) &&
+      squares.Count(4) == 1 && *squares.MaxElement() == 16;
+}
+
+static_assert(CheckSquares(), "constexpr PushBack/Insert/Erase/PopBack");
+static_assert(SumOfSquares(6) == 29, "constexpr iteration");
+
+constexpr int primes[] = {2, 3, 5, 7, 11};
+constexpr VLVector<int, 2 * TEST_STATIC_CAPACITY> primes_table(
+    primes, primes + 5);
+constexpr VLVector<int, TEST_STATIC_CAPACITY> sevens(size_t(3), 7);
+static_assert(primes_table.Size() == 5 && primes_table[4] == 11 &&
+                  primes_table.Find(7) == primes_table.begin() + 3,
+              "constexpr table from a range");
+static_assert(sevens.Size() == 3 && sevens.Count(7) == 3,
+              "constexpr table of copies");
+
+int Test5() {
+  //the same operations at run time
+  volatile int count = 6;
+  VLVector<int, 2 * TEST_STATIC_CAPACITY> squares = Squares(count);
+  VLVector<int, 2 * TEST_STATIC_CAPACITY> copy(primes, primes + 5);
+  if (squares.Size() != 5 || squares[4] != 16 ||
+      SumOfSquares(count) != 29 || copy != primes_table) {
+    return TEST5FAIL;
+  }
+  return SUCCESS;
+}
+#else
+int Test5() {
+  return SUCCESS;
+}
+#endif
+
+/**
+ * compares Find, Contains, Count, MinElement, MaxElement and operator== with
+ * the std algorithms for a vector whose elements are drawn from a few
+ * distinct values (so the counts are high and the searched values are
+ * often, but not always, present)
+ * @tparam T elements type
+ * @param values the distinct values (the first one is never stored)
+ * @param size vector's size
+ * @param seed generator state
+ * @return true if all results matched
+ */
+template<typename T>
+static bool SearchMatchesStd(const std::vector<T> &values, size_t size,
+                             unsigned long long &seed) {
+  VLVector<T, TEST_STATIC_CAPACITY> vec;
+  for (size_t i = 0; i < size; ++i) {
+    vec.PushBack(values[1 + Next(seed) % (values.size() - 1)]);
+  }
+  const T *first = vec.Data();
+  const T *last = first + size;
+  for (const T &value : values) {
+    const T *found = std::find(first, last, value);
+    if (vec.Find(value) - vec.cbegin() != found - first ||
+        vec.Contains(value) != (found != last) ||
+        vec.Count(value) != size_t(std::count(first, last, value))) {
+      return false;
+    }
+  }
+  if (vec.MinElement() - vec.cbegin() != std::min_element(first, last) -
+      first || vec.MaxElement() - vec.cbegin() !=
+      std::max_element(first, last) - first) {
+    return false;
+  }
+  //a copy is equal to the vector unless it holds a NaN
+  VLVector<T, TEST_STATIC_CAPACITY> copy(first, last);
+  if ((copy == vec) != std::equal(first, last, copy.Data())) {
+    return false;
+  }
+  if (size > 0) {
+    copy.Data()[Next(seed) % size] = values[0];
+    if (copy == vec) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * runs SearchMatchesStd for every size up to SEARCH_MAX_SIZE and for
+ * SEARCH_LONG_SIZE
+ * @tparam T elements type
+ * @param values the distinct values (the first one is never stored)
+ * @return true if all results matched
+ */
+template<typename T>
+static bool SearchMatchesStd(const std::vector<T> &values) {
+  unsigned long long seed = values.size();
+  for (size_t size = 0; size <= SEARCH_MAX_SIZE; ++size) {
+    if (!SearchMatchesStd(values, size, seed)) {
+      return false;
+    }
+  }
+  return SearchMatchesStd(values, SEARCH_LONG_SIZE, seed);
+}
+
+int Test6() {
+  const double nan = std::nan("");
+  if (!SearchMatchesStd<int>({-7, 3, -1, 3000000, 0}) ||
+      !SearchMatchesStd<uint8_t>({200, 1, 255, 0}) ||
+      !SearchMatchesStd<int8_t>({-128, 127, -1, 0, 5}) ||
+      !SearchMatchesStd<int16_t>({9, -300, 300, 0}) ||
+      !SearchMatchesStd<uint64_t>({5, uint64_t(1) << 40, 0, ~uint64_t(0)}) ||
+      !SearchMatchesStd<int64_t>({-5, int64_t(1) << 40, -(int64_t(1) << 40),
+                                  0}) ||
+      !SearchMatchesStd<float>({7.5f, -0.0f, 0.0f, 1e30f, -2.5f,
+                                float(nan)}) ||
+      !SearchMatchesStd<double>({7.5, 1e-300, -0.0, 3.25, nan}) ||
+      !SearchMatchesStd<Tracked>({Tracked(4), Tracked(1), Tracked(2)})) {
+    return TEST6FAIL;
+  }
+  return tracked_alive == 0 ? SUCCESS : TEST6FAIL;
+}
+
+/**
+ * ThrowingCopy element whose copy constructor throws once a given amount of
+ * copies were made
+ */
+struct ThrowingCopy {
+  /**
+   * copies made so far and the copy that throws (0: none)
+   */
+  static int copies;
+  static int throw_at;
+
+  int value;
+
+  ThrowingCopy(int v) : value(v) {}
+
+  ThrowingCopy(const ThrowingCopy &other) : value(other.value) {
+    if (++copies == throw_at) {
+      throw std::runtime_error("copy failed");
+    }
+  }
+
+  ThrowingCopy(ThrowingCopy &&other) noexcept = default;
+  ThrowingCopy &operator=(const ThrowingCopy &other) = default;
+  ThrowingCopy &operator=(ThrowingCopy &&other) noexcept = default;
+
+  bool operator<(const ThrowingCopy &other) const {
+    return value < other.value;
+  }
+};
+
+int ThrowingCopy::copies = 0;
+int ThrowingCopy::throw_at = 0;
+
+int Test7() {
+  //each size of the inserted range, the copy of each of its elements
+  //throwing, with the set both in its static array and on the heap
+  for (int static_elems = 2; static_elems <= 3 * TEST_STATIC_CAPACITY;
+       static_elems += 3 * TEST_STATIC_CAPACITY - 2) {
+    std::vector<ThrowingCopy> range = {7, 1, 3, 100, -4, 8, 0, 9};
+    for (size_t count = 1; count <= range.size(); ++count) {
+      for (int throw_at = 1; throw_at <= int(count); ++throw_at) {
+        FlatVLSet<ThrowingCopy, TEST_STATIC_CAPACITY> set;
+        for (int i = 0; i < static_elems; ++i) {
+          set.Insert(ThrowingCopy(5 * i + 5));
+        }
+        ThrowingCopy::copies = 0;
+        ThrowingCopy::throw_at = throw_at;
+        try {
+          set.Insert(range.begin(), range.begin() + count);
+          return TEST7FAIL;
+        } catch (const std::runtime_error &) {
+        }
+        ThrowingCopy::throw_at = 0;
+        //unchanged: the old elements, still sorted and searchable
+        if (set.Size() != size_t(static_elems)) {
+          return TEST7FAIL;
+        }
+        int expected = 5;
+        for (const ThrowingCopy &elem : set) {
+          if (elem.value != expected || !set.Contains(ThrowingCopy(expected))) {
+            return TEST7FAIL;
+          }
+          expected += 5;
+        }
+        set.Insert(range.begin(), range.begin() + count);
+        if (set.Size() != size_t(static_elems) + count ||
+            !std::is_sorted(set.begin(), set.end())) {
+          return TEST7FAIL;
+        }
+      }
+    }
+  }
+  return SUCCESS;
+}
+
+/**
+ * @return true if set holds the same keys as expected, in the same order
+ */
+template<typename Set>
+static bool SameKeys(const Set &set, const std::set<int> &expected) {
+  return set.Size() == expected.size() && set.Empty() == expected.empty() &&
+      std::equal(set.begin(), set.end(), expected.begin());
+}
+
+/**
+ * @return true if map holds the same elements as expected, in the same order
+ */
+template<typename Map>
+static bool SameElements(const Map &map, const std::map<int, int> &expected) {
+  return map.Size() == expected.size() &&
+      std::equal(map.begin(), map.end(), expected.begin(),
+                 [](const std::pair<int, int> &lhs,
+                    const std::pair<const int, int> &rhs) {
+                   return lhs.first == rhs.first && lhs.second == rhs.second;
+                 });
+}
+
+/**
+ * applies the same random operations to a FlatVLSet and a std::set
+ * @return true if they never differed
+ */
+static bool FlatSetMatchesStd() {
+  FlatVLSet<int, TEST_STATIC_CAPACITY> set;
+  std::set<int> expected;
+  unsigned long long seed = 11;
+  for (int step = 0; step < FLAT_STEPS; ++step) {
+    int key = int(Next(seed) % FLAT_KEY_RANGE);
+    switch (Next(seed) % 5) {
+      case 0: {
+        auto result = set.Insert(key);
+        auto expected_result = expected.insert(key);
+        if (result.second != expected_result.second || *result.first != key) {
+          return false;
+        }
+        break;
+      }
+      case 1:
+        if (set.Erase(key) != expected.erase(key)) {
+          return false;
+        }
+        break;
+      case 2: {
+        //with duplicates, inside the range and with the set
+        std::vector<int> range;
+        size_t count = Next(seed) % (2 * TEST_STATIC_CAPACITY);
+        for (size_t i = 0; i < count; ++i) {
+          range.push_back(int(Next(seed) % FLAT_KEY_RANGE));
+        }
+        set.Insert(range.begin(), range.end());
+        expected.insert(range.begin(), range.end());
+        break;
+      }
+      case 3:
+        if (!expected.empty() && Next(seed) % 4 == 0) {
+          auto position = set.Find(*expected.begin());
+          set.Erase(position);
+          expected.erase(expected.begin());
+        }
+        break;
+      default:
+        if (expected.size() > FLAT_KEY_RANGE / 2) {
+          set.Clear();
+          expected.clear();
+        }
+        break;
+    }
+    auto found = set.Find(key);
+    if ((found == set.end()) != (expected.count(key) == 0) ||
+        set.Contains(key) != (expected.count(key) == 1) ||
+        set.Count(key) != expected.count(key) ||
+        set.LowerBound(key) - set.begin() != std::distance(
+            expected.begin(), expected.lower_bound(key)) ||
+        set.UpperBound(key) - set.begin() != std::distance(
+            expected.begin(), expected.upper_bound(key)) ||
+        !SameKeys(set, expected)) {
+      std::cerr << "set differs after step " << step << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * applies the same random operations to a FlatVLMap and a std::map
+ * @return true if they never differed
+ */
+static bool FlatMapMatchesStd() {
+  FlatVLMap<int, int, TEST_STATIC_CAPACITY> map;
+  std::map<int, int> expected;
+  unsigned long long seed = 12;
+  for (int step = 0; step < FLAT_STEPS; ++step) {
+    int key = int(Next(seed) % FLAT_KEY_RANGE);
+    int value = int(Next(seed) % FLAT_KEY_RANGE);
+    switch (Next(seed) % 7) {
+      case 0:
+        if (map.Insert({key, value}).second !=
+            expected.insert({key, value}).second) {
+          return false;
+        }
+        break;
+      case 1:
+        if (map.TryEmplace(key, value).second !=
+            expected.try_emplace(key, value).second) {
+          return false;
+        }
+        break;
+      case 2:
+        if (map.InsertOrAssign(key, value).second !=
+            expected.insert_or_assign(key, value).second) {
+          return false;
+        }
+        break;
+      case 3:
+        map[key] += value;
+        expected[key] += value;
+        break;
+      case 4:
+        if (map.Erase(key) != expected.erase(key)) {
+          return false;
+        }
+        break;
+      case 5: {
+        //the first of equal keys wins, like repeated Insert
+        std::vector<std::pair<int, int>> range;
+        size_t count = Next(seed) % (2 * TEST_STATIC_CAPACITY);
+        for (size_t i = 0; i < count; ++i) {
+          range.emplace_back(int(Next(seed) % FLAT_KEY_RANGE), int(i));
+        }
+        map.Insert(range.begin(), range.end());
+        expected.insert(range.begin(), range.end());
+        break;
+      }
+      default:
+        if (expected.size() > FLAT_KEY_RANGE / 2) {
+          map.Clear();
+          expected.clear();
+        }
+        break;
+    }
+    auto found = expected.find(key);
+    if (found == expected.end()) {
+      try {
+        map.At(key);
+        return false;
+      } catch (const std::out_of_range &) {
+      }
+    } else if (map.At(key) != found->second) {
+      return false;
+    }
+    if (!SameElements(map, expected)) {
+      std::cerr << "map differs after step " << step << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * HasContains true if Set has a Contains() that accepts a Lookup
+ */
+template<typename Set, typename Lookup, typename = void>
+struct HasContains : std::false_type {};
+
+template<typename Set, typename Lookup>
+struct HasContains<Set, Lookup, std::void_t<decltype(
+    std::declval<const Set &>().Contains(std::declval<const Lookup &>()))>>
+    : std::true_type {};
+
+//std::string_view doesn't convert to std::string: a lookup with it compiles
+//only with a transparent Compare
+static_assert(HasContains<FlatVLSet<std::string, TEST_STATIC_CAPACITY,
+                                    std::less<>>, std::string_view>::value,
+              "heterogeneous lookup with std::less<>");
+static_assert(!HasContains<FlatVLSet<std::string, TEST_STATIC_CAPACITY>,
+                           std::string_view>::value,
+              "no heterogeneous lookup with std::less<std::string>");
+
+/**
+ * heterogeneous lookups of std::string keys with std::string_view and
+ * const char *
+ * @return true if they found what they should
+ */
+static bool HeterogeneousLookup() {
+  FlatVLSet<std::string, TEST_STATIC_CAPACITY, std::less<>> set =
+      {"pear", "apple", "fig", "banana", "kiwi", "apple"};
+  std::string_view fig = "fig";
+  if (set.Size() != 5 || !set.Contains(fig) || set.Contains("grape") ||
+      *set.Find(std::string_view("kiwi")) != "kiwi" ||
+      set.Find(std::string_view("plum")) != set.end() ||
+      *set.begin() != "apple") {
+    return false;
+  }
+  FlatVLMap<std::string, int, TEST_STATIC_CAPACITY, std::less<>> map =
+      {{"one", 1}, {"two", 2}, {"three", 3}, {"one", 10}};
+  auto two = map.Find(std::string_view("two"));
+  if (two == map.end()) {
+    return false;
+  }
+  two->second = 20;
+  const auto &const_map = map;
+  return map.Size() == 3 && map.At("one") == 1 &&
+      const_map.Find(std::string_view("two"))->second == 20 &&
+      const_map.Contains(std::string_view("three")) &&
+      !const_map.Contains(std::string_view("four"));
+}
+
+int Test8() {
+  if (!FlatSetMatchesStd() || !FlatMapMatchesStd() ||
+      !HeterogeneousLookup()) {
+    return TEST8FAIL;
+  }
+  return SUCCESS;
+}
+
+/**
+ * @return the element appended by a writer thread as its append'th element
+ */
+static std::string ConcurrentElement(int writer, int append) {
+  return std::to_string(writer) + ":" + std::to_string(append);
+}
+
+/**
+ * reads a ConcurrentVLVector while it is appended to: every element
+ * ForEach reaches must be whole, and a writer's elements must come in the
+ * order it appended them
+ * @param vec the vector
+ * @param writing cleared when the writers are done
+ * @return true if every read was consistent
+ */
+static bool ReadWhileAppending(
+    const ConcurrentVLVector<std::string, TEST_STATIC_CAPACITY> &vec,
+    const std::atomic<bool> &writing) {
+  bool consistent = true;
+  do {
+    std::vector<int> last_append(CONCURRENT_WRITERS, -1);
+    size_t last_index = 0;
+    bool first = true;
+    vec.ForEach([&](size_t index, const std::string &elem) {
+      size_t colon = elem.find(':');
+      int writer = std::stoi(elem.substr(0, colon));
+      int append = std::stoi(elem.substr(colon + 1));
+      if ((!first && index <= last_index) || writer < 0 ||
+          writer >= CONCURRENT_WRITERS || append <= last_append[writer] ||
+          elem != ConcurrentElement(writer, append) ||
+          !vec.IsPublished(index) || &vec.At(index) != &elem) {
+        consistent = false;
+      }
+      last_append[writer] = append;
+      last_index = index;
+      first = false;
+    });
+  } while (consistent && writing.load());
+  return consistent;
+}
+
+int Test9() {
+  ConcurrentVLVector<std::string, TEST_STATIC_CAPACITY> vec;
+  std::atomic<bool> writing(true);
+  std::atomic<int> ready(0);
+  std::vector<std::thread> writers;
+  for (int writer = 0; writer < CONCURRENT_WRITERS; ++writer) {
+    writers.emplace_back([&vec, &ready, writer]() {
+      //all writers start together, so they race on the segment boundaries
+      ready.fetch_add(1);
+      while (ready.load() < CONCURRENT_WRITERS) {
+        std::this_thread::yield();
+      }
+      for (int append = 0; append < CONCURRENT_APPENDS; ++append) {
+        vec.EmplaceBack(ConcurrentElement(writer, append));
+      }
+    });
+  }
+  bool consistent = true;
+  std::thread reader([&]() { consistent = ReadWhileAppending(vec, writing); });
+  for (std::thread &thread : writers) {
+    thread.join();
+  }
+  writing.store(false);
+  reader.join();
+
+  //every element exactly once, each writer's in its order
+  const size_t total = size_t(CONCURRENT_WRITERS) * CONCURRENT_APPENDS;
+  std::vector<int> next_append(CONCURRENT_WRITERS, 0);
+  size_t seen = 0;
+  vec.ForEach([&](size_t, const std::string &elem) {
+    size_t colon = elem.find(':');
+    int writer = std::stoi(elem.substr(0, colon));
+    if (elem != ConcurrentElement(writer, next_append[writer]++)) {
+      consistent = false;
+    }
+    ++seen;
+  });
+  if (!consistent || vec.Size() != total || seen != total ||
+      !vec.IsPublished(total - 1) || vec.IsPublished(total)) {
+    return TEST9FAIL;
+  }
+  try {
+    vec.At(total);
+    return TEST9FAIL;
+  } catch (const std::out_of_range &) {
+  }
+  vec.Clear();
+  if (!vec.Empty() || vec.PushBack("again") != 0 || vec[0] != "again") {
+    return TEST9FAIL;
+  }
+  //refilled past the static cells: the segments are allocated again
+  for (int append = 1; append < 10 * TEST_STATIC_CAPACITY; ++append) {
+    vec.PushBack(ConcurrentElement(0, append));
+  }
+  if (vec.At(10 * TEST_STATIC_CAPACITY - 1) !=
+      ConcurrentElement(0, 10 * TEST_STATIC_CAPACITY - 1)) {
+    return TEST9FAIL;
+  }
+  return SUCCESS;
+}